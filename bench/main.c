@@ -0,0 +1,150 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/uio.h>
+
+/*
+ * Environment for the benchmarks (see "run.lua"):
+ *  - same as "env/main.c", with a monotonic clock for "CEU_CALLBACK_CLOCK"
+ *  - outputs (all of type "int") are written to "/dev/null"
+ *  - prints the measures of the whole run to stderr:
+ *      ns=<wall time> rss=<max KB>
+ *    and, with "--ceu-features-stats":
+ *      reactions=<inputs> trails=<visited>
+ *      lat=<longest reaction, rounded up to a power of 2 (us)>
+ */
+
+static usize bench_clock (void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (usize)ts.tv_sec*1000000 + ts.tv_nsec/1000;    /* us */
+}
+
+static int bench_null;
+
+#ifdef CEU_FEATURES_OUTPUT_BATCH
+static void bench_writev (tceu_output_batch* b) {
+    struct iovec iov[64];
+    tceu_output* o = (tceu_output*) b->buf;
+    usize i, n = 0;
+    for (i=0; i<b->n; i++) {
+        iov[n].iov_base = o->params;
+        iov[n].iov_len  = o->size;
+        if (++n == 64) {
+            writev(bench_null, iov, n);
+            n = 0;
+        }
+        o = CEU_OUTPUT_NXT(o);
+    }
+    if (n > 0) {
+        writev(bench_null, iov, n);
+    }
+}
+#endif
+
+int ceu_callback_bench (int cmd, tceu_callback_val p1, tceu_callback_val p2
+#ifdef CEU_FEATURES_TRACE
+                       , tceu_trace trace
+#endif
+                       )
+{
+    int is_handled;
+
+    switch (cmd) {
+        case CEU_CALLBACK_WCLOCK_DT:
+            is_handled = 1;
+            ceu_callback_ret.num = CEU_WCLOCK_INACTIVE;
+            break;
+        case CEU_CALLBACK_ABORT:
+            is_handled = 1;
+            abort();
+            break;
+        case CEU_CALLBACK_LOG: {
+            is_handled = 1;
+            switch (p1.num) {
+                case 0:
+                    printf("%s", (char*)p2.ptr);
+                    break;
+                case 1:
+                    printf("%p", p2.ptr);
+                    break;
+                case 2:
+                    printf("%d", p2.num);
+                    break;
+            }
+            break;
+        }
+        case CEU_CALLBACK_REALLOC:
+            is_handled = 1;
+            ceu_callback_ret.ptr = realloc(p1.ptr, p2.size);
+            break;
+        case CEU_CALLBACK_CLOCK:
+            is_handled = 1;
+            ceu_callback_ret.size = bench_clock();
+            break;
+        case CEU_CALLBACK_OUTPUT:
+            is_handled = 1;
+            write(bench_null, p2.ptr, sizeof(int));
+            break;
+#ifdef CEU_FEATURES_OUTPUT_BATCH
+        case CEU_CALLBACK_OUTPUT_BATCH:
+            is_handled = 1;
+            bench_writev((tceu_output_batch*) p2.ptr);
+            ceu_callback_ret.num = 1;
+            break;
+#endif
+        default:
+            is_handled = 0;
+    }
+    return is_handled;
+}
+
+int main (int argc, char* argv[])
+{
+    tceu_callback cb = { &ceu_callback_bench, NULL };
+    struct timespec t0, t1;
+
+    bench_null = open("/dev/null", O_WRONLY);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int ret = ceu_loop(&cb, argc, argv);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+
+    fprintf(stderr, "ns=%llu rss=%ld",
+            (unsigned long long) ((t1.tv_sec-t0.tv_sec)*1000000000LL + (t1.tv_nsec-t0.tv_nsec)),
+            (long) ru.ru_maxrss);
+
+#ifdef CEU_FEATURES_STATS
+    tceu_stats stats;
+    ceu_stats(&stats);
+
+    /* reactions to inputs (including the clock and "async" resumes) */
+    u64 n = 0;
+    int i;
+    for (i=CEU_INPUT__ASYNC; i<CEU_EVENT__MIN; i++) {
+        n += stats.reactions[i];
+    }
+
+    /* highest bucket of the latency histogram */
+    u32 lat = 0;
+    for (i=0; i<CEU_STATS_LATENCY_N; i++) {
+        if (stats.latency[i] > 0) {
+            lat = (i == 0) ? 0 : (1u << i);
+        }
+    }
+
+    fprintf(stderr, " reactions=%llu trails=%lu lat=%lu",
+            (unsigned long long) n,
+            (unsigned long) stats.trails,
+            (unsigned long) lat);
+#endif
+    fprintf(stderr, "\n");
+
+    return ret;
+}
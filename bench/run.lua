@@ -0,0 +1,171 @@
+#!/usr/bin/env lua5.3
+
+-- Benchmarks (`make bench [BENCH_ARGS=...]`):
+--
+--  $ cd bench/ && lua5.3 run.lua [--save] [<name> ...]
+--
+-- Compiles each `<name>.ceu` (all by default) with `main.c` twice:
+--  - without `--ceu-features-stats`, runs it a few times, keeping the fastest
+--    run for `ms`, `rss`, and `size`
+--  - with `--ceu-features-stats`, runs it once for `reactions`, `trails`, and
+--    `lat` (the counters are not free, so they stay out of the timed runs)
+-- Measures:
+--  - reactions:    reactions to inputs, including `async` resumes
+--  - ms:           wall time of `ceu_loop`
+--  - ns/reaction:  wall time of `ceu_loop` per reaction
+--  - trails:       trails visited per reaction
+--  - rss:          maximum resident set size (KB)
+--  - lat:          longest reaction (us, rounded up to a power of 2)
+--  - size:         size of the binary (bytes)
+-- Results go to `results.lua`, and are compared against `baseline.lua`.
+-- `--save` also stores them as the new `baseline.lua`.
+--
+-- Environment:
+--  - CEU:      compiler (default `../src/lua/ceu`, see `make compiler`)
+--  - CEU_ARGS: extra `--ceu-*` options (e.g., `--ceu-input-tables=true`)
+--  - CC_ARGS:  extra C compiler options (default `-O2`)
+--  - RUNS:     runs of each benchmark (default `3`)
+
+local CEU      = os.getenv'CEU'      or '../src/lua/ceu'
+local CEU_ARGS = os.getenv'CEU_ARGS' or ''
+local CC_ARGS  = os.getenv'CC_ARGS'  or '-O2'
+local RUNS     = tonumber(os.getenv'RUNS' or 3)
+
+-- name -> features
+local BENCHS = {
+    { 'trails',  '' },
+    { 'codes',   '' },
+    { 'pools',   '--ceu-features-pool=true' },
+    { 'kills',   '--ceu-features-pool=true' },
+    { 'nesting', '--ceu-features-pool=true' },
+    { 'timers',  '--ceu-features-pool=true' },
+    { 'emits',   '' },
+    { 'vectors', '--ceu-features-dynamic=true' },
+    { 'outputs', '' },
+    { 'asyncs',  '' },
+    { 'lua',     '--ceu-features-lua=true --ceu-features-dynamic=true' },
+}
+
+local SAVE = false
+local ONLY = nil
+for _, v in ipairs(arg) do
+    if v == '--save' then
+        SAVE = true
+    else
+        ONLY = ONLY or {}
+        ONLY[v] = true
+    end
+end
+
+local function SIZE (file)
+    local f = assert(io.open(file))
+    local n = f:seek('end')
+    f:close()
+    return n
+end
+
+local function BUILD (name, features)
+    local exe = os.tmpname()
+    local cmd = CEU..' --pre --pre-input='..name..'.ceu --pre-args="-I../include" '..
+                    '--ceu --ceu-err-unused=pass '..features..' '..CEU_ARGS..' '..
+                    '--env --env-types=../env/types.h --env-threads=../env/threads.h --env-main=main.c '..
+                    '--cc --cc-args="'..CC_ARGS..' -llua5.3 -lpthread" --cc-output='..exe..' 2>&1'
+    local f = assert(io.popen(cmd))
+    local out = f:read'*a'
+    assert(f:close(), name..': compilation failed\n'..out)
+    return exe
+end
+
+local function EXEC (name, exe)
+    local f = assert(io.popen(exe..' 2>&1 >/dev/null'))
+    local out = f:read'*a'
+    local _, _, status = f:close()
+    assert(status == 1, name..': unexpected result ('..tostring(status)..')\n'..out)
+
+    local t = {}
+    for k, v in string.gmatch(out, '(%w+)=(%d+)') do
+        t[k] = tonumber(v)
+    end
+    assert(t.ns and t.rss, name..': no measures\n'..out)
+    return t
+end
+
+local function RUN (name, features)
+    -- timed runs
+    local exe = BUILD(name, features)
+    local ret = { size=SIZE(exe) }
+    for i=1, RUNS do
+        local t = EXEC(name, exe)
+        ret.ns  = math.min(ret.ns  or math.huge, t.ns)
+        ret.rss = math.min(ret.rss or math.huge, t.rss)
+    end
+    os.remove(exe)
+
+    -- counters
+    local exe = BUILD(name, '--ceu-features-stats=true '..features)
+    local t = EXEC(name, exe)
+    os.remove(exe)
+    assert(t.reactions and t.reactions>0, name..': no counters')
+
+    ret.reactions   = t.reactions
+    ret.lat         = t.lat
+    ret.ms          = ret.ns / 1e6
+    ret.ns_reaction = ret.ns / ret.reactions
+    ret.reactions_s = math.floor(ret.reactions * 1e9 / ret.ns)
+    ret.trails      = t.trails / ret.reactions
+    return ret
+end
+
+local function LOAD (file)
+    local f = loadfile(file)
+    return f and f() or nil
+end
+
+local function WRITE (file, results)
+    local f = assert(io.open(file, 'w'))
+    f:write('return {\n')
+    for _, t in ipairs(BENCHS) do
+        local r = results[t[1]]
+        if r then
+            f:write(string.format('    %-8s = { reactions=%d, ms=%.2f, ns_reaction=%.2f, reactions_s=%d, '..
+                                  'trails=%.2f, rss=%d, lat=%d, size=%d },\n',
+                    t[1], r.reactions, r.ms, r.ns_reaction, r.reactions_s, r.trails, r.rss, r.lat, r.size))
+        end
+    end
+    f:write('}\n')
+    f:close()
+end
+
+-------------------------------------------------------------------------------
+
+local base = LOAD'baseline.lua' or {}
+local results = {}
+
+print(string.format('%-8s %10s %12s %12s %10s %10s %10s %10s',
+                    'bench', 'ms', 'ns/reaction', 'reactions/s', 'trails', 'rss(KB)', 'lat(us)', 'size'))
+for _, t in ipairs(BENCHS) do
+    local name, features = table.unpack(t)
+    if (not ONLY) or ONLY[name] then
+        local r = RUN(name, features)
+        results[name] = r
+        print(string.format('%-8s %10.2f %12.2f %12d %10.2f %10d %10d %10d',
+                            name, r.ms, r.ns_reaction, r.reactions_s, r.trails, r.rss, r.lat, r.size))
+
+        local b = base[name]
+        if b then
+            local function D (k)
+                if not b[k] or b[k]==0 then
+                    return '-'
+                end
+                return string.format('%+.1f%%', (r[k]-b[k])*100/b[k])
+            end
+            print(string.format('%-8s %10s %12s %12s %10s %10s %10s %10s',
+                                '  (base)', D'ms', D'ns_reaction', D'reactions_s', D'trails', D'rss', D'lat', D'size'))
+        end
+    end
+end
+
+WRITE('results.lua', results)
+if SAVE then
+    WRITE('baseline.lua', results)
+end
@@ -0,0 +1,71 @@
+/* "env/main.c" with "CEU_FEATURES_HITS" */
+
+#include <signal.h>
+#include <sys/time.h>
+
+/*
+ * `CEU_HITS=<file>`: writes a profile of the labels to <file> on termination,
+ * hottest first:
+ *      <samples> <hits> <label> <file>:<line>
+ * Samples are taken at each millisecond of CPU time ("SIGPROF") from the
+ * running label ("CEU_LABEL_NONE" accounts for the runtime and environment).
+ * Labels are numbered as in "--ceu-label-map".
+ */
+static char* CEU_HITS_FILE = NULL;
+static u32   CEU_HITS_SAMPLES[CEU_LABELS_N];
+
+static void ceu_hits_sample (int sig) {
+    CEU_HITS_SAMPLES[CEU_APP.lbl_cur]++;
+}
+
+static int ceu_hits_cmp (const void* p1, const void* p2) {
+    int l1 = *(const int*)p1;
+    int l2 = *(const int*)p2;
+    if (CEU_HITS_SAMPLES[l1] != CEU_HITS_SAMPLES[l2]) {
+        return (CEU_HITS_SAMPLES[l1] < CEU_HITS_SAMPLES[l2]) ? 1 : -1;
+    } else if (CEU_APP.hits[l1] != CEU_APP.hits[l2]) {
+        return (CEU_APP.hits[l1] < CEU_APP.hits[l2]) ? 1 : -1;
+    } else {
+        return l1 - l2;
+    }
+}
+
+static void ceu_hits_report (FILE* f) {
+    int lbls[CEU_LABELS_N];
+    int i;
+    for (i=0; i<CEU_LABELS_N; i++) {
+        lbls[i] = i;
+    }
+    qsort(lbls, CEU_LABELS_N, sizeof(int), ceu_hits_cmp);
+    for (i=0; i<CEU_LABELS_N; i++) {
+        int l = lbls[i];
+        if (CEU_HITS_SAMPLES[l]==0 && CEU_APP.hits[l]==0) {
+            break;
+        }
+        fprintf(f, "%u %u %d %s\n", CEU_HITS_SAMPLES[l], CEU_APP.hits[l], l,
+                (l == CEU_LABEL_NONE) ? "-" : CEU_LABELS_LINES[l]);
+    }
+}
+
+static void ceu_hits_start (void) {
+    CEU_HITS_FILE = getenv("CEU_HITS");
+    if (CEU_HITS_FILE != NULL) {
+        struct itimerval it = { {0,1000}, {0,1000} };
+        signal(SIGPROF, ceu_hits_sample);
+        setitimer(ITIMER_PROF, &it, NULL);
+    }
+}
+
+static void ceu_hits_stop (void) {
+    if (CEU_HITS_FILE != NULL) {
+        struct itimerval it = { {0,0}, {0,0} };
+        setitimer(ITIMER_PROF, &it, NULL);
+        FILE* f = fopen(CEU_HITS_FILE, "w");
+        if (f == NULL) {
+            perror(CEU_HITS_FILE);
+            exit(EXIT_FAILURE);
+        }
+        ceu_hits_report(f);
+        fclose(f);
+    }
+}
@@ -0,0 +1,408 @@
+/* "env/main.c" with "CEU_IO" (after "par.h" and "wclock.h") */
+
+#ifndef __linux__
+#error "include/io.ceu" requires "epoll" (Linux)
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+/*
+ * File descriptors as inputs ("include/io.ceu"):
+ *  - "CEU_IO_FDS[fd]" holds the pending requests of each "fd"
+ *  - "CEU_CALLBACK_STEP" waits for the ready "fd"s (and "CEU_WCLOCK_FD"),
+ *    serves their requests, and emits one input for each completed request
+ *  - reads go directly to the free space of the requesting vector, which
+ *    only grows ("len") when "IO_READ" is emitted
+ *  - reads and writes are tried as soon as requested, and only wait for
+ *    "EPOLLIN"/"EPOLLOUT" if the "fd" is not ready, but always complete in a
+ *    later reaction ("CEU_IO_DONE")
+ *  - reads are not tried if the previous one drained the "fd" ("rd_empty"),
+ *    until "epoll" reports it again
+ *  - "fd"s stay in the "epoll" set after their requests complete, as the next
+ *    request usually follows, until an unwanted event occurs
+ */
+#ifndef CEU_IO_MAX
+#define CEU_IO_MAX    1024      /* highest "fd" + 1 */
+#endif
+#ifndef CEU_IO_EVENTS
+#define CEU_IO_EVENTS 64        /* "fd"s served per "epoll_wait" */
+#endif
+#ifndef CEU_IO_GROW
+#define CEU_IO_GROW   4096      /* bytes added to full dynamic vectors */
+#endif
+
+typedef struct tceu_io {
+    tceu_vector* rd;
+    ssize_t      rd_n;          /* "rd" completed: bytes, "0" on EOF, or "-errno" */
+    bool         rd_done;
+    bool         rd_empty;      /* drained by the last read (wait for "EPOLLIN") */
+    tceu_vector* wr;
+    usize        wr_i;          /* bytes of "wr" already written */
+    int          wr_err;        /* "wr" completed: "-1" ok, or "errno" */
+    bool         queued;        /* in "CEU_IO_DONE" */
+    bool         accept;
+    u32          events;        /* as in the "epoll" set */
+} tceu_io;
+
+static tceu_io CEU_IO_FDS[CEU_IO_MAX];
+static int     CEU_IO_EP = -1;
+static int     CEU_IO_DONE[CEU_IO_MAX];     /* "fd"s with "rd_done" or "wr_err" set */
+static int     CEU_IO_DONE_N = 0;
+
+/* "strict" also removes the events that nobody wants
+ * returns "-errno" if "epoll" cannot wait for "fd" (e.g., a regular file) */
+static int ceu_io_sync (int fd, bool strict) {
+    tceu_io* io = &CEU_IO_FDS[fd];
+    u32 events = (((io->rd!=NULL && !io->rd_done) || io->accept) ? EPOLLIN  : 0) |
+                 ((io->wr!=NULL && io->wr_err==0)                ? EPOLLOUT : 0);
+    if (!strict) {
+        events |= io->events;
+    }
+    if (events != io->events) {
+        int r = 0;
+        struct epoll_event ev;
+        ev.events  = events;
+        ev.data.fd = fd;
+        if (io->events == 0) {
+            r = epoll_ctl(CEU_IO_EP, EPOLL_CTL_ADD, fd, &ev);
+        } else if (events == 0) {
+            epoll_ctl(CEU_IO_EP, EPOLL_CTL_DEL, fd, &ev);
+        } else if (epoll_ctl(CEU_IO_EP, EPOLL_CTL_MOD, fd, &ev)==-1 && errno==ENOENT) {
+            /* closed without "ceu_io_close" and reopened */
+            r = epoll_ctl(CEU_IO_EP, EPOLL_CTL_ADD, fd, &ev);
+        }
+        if (r == -1) {
+            return -errno;
+        }
+        io->events = events;
+    }
+    return 0;
+}
+
+static int ceu_io_check (int fd) {
+    if (fd<0 || fd>=CEU_IO_MAX || CEU_IO_EP==-1) {
+        return -EBADF;
+    }
+    return 0;
+}
+
+/* completed when requested: emitted on the next step */
+static void ceu_io_done (int fd) {
+    if (!CEU_IO_FDS[fd].queued) {
+        CEU_IO_FDS[fd].queued = 1;
+        CEU_IO_DONE[CEU_IO_DONE_N++] = fd;
+    }
+}
+
+/* a "-1" that is not "EAGAIN" completes the request with "IO_CLOSE" */
+#define CEU_IO_AGAIN(r) ((r)==-1 && (errno==EAGAIN || errno==EWOULDBLOCK || errno==EINTR))
+
+/* returns if the request completed ("rd_done" set) */
+static bool ceu_io_recv (int fd) {
+    tceu_io* io = &CEU_IO_FDS[fd];
+    tceu_vector* v = io->rd;
+    ssize_t r;
+    if (v->len==v->max && v->is_dyn && !v->is_freezed) {
+        ceu_vector_setmax_ex(v, v->max+CEU_IO_GROW, 0, CEU_TRACE_null);
+    }
+    if (v->len == v->max) {
+        r = -1;
+        errno = ENOBUFS;
+    } else {
+        r = read(fd, &v->buf[v->len], v->max-v->len);
+    }
+    if (CEU_IO_AGAIN(r)) {
+        io->rd_empty = 1;
+        return 0;
+    }
+    io->rd_empty = (r>0 && (usize)r<v->max-v->len);     /* short read */
+    io->rd_n     = (r == -1) ? -errno : r;
+    io->rd_done = 1;
+    return 1;
+}
+
+/* returns if the request completed ("wr_err" set) */
+static bool ceu_io_send (int fd) {
+    tceu_io* io = &CEU_IO_FDS[fd];
+    tceu_vector* v = io->wr;
+    while (io->wr_i < v->len) {
+        ssize_t r = send(fd, &v->buf[io->wr_i], v->len-io->wr_i, MSG_NOSIGNAL);
+        if (r==-1 && errno==ENOTSOCK) {
+            r = write(fd, &v->buf[io->wr_i], v->len-io->wr_i);
+        }
+        if (CEU_IO_AGAIN(r)) {
+            return 0;
+        } else if (r <= 0) {
+            io->wr_err = (r == 0) ? EPIPE : errno;
+            return 1;
+        }
+        io->wr_i += r;
+    }
+    io->wr_err = -1;
+    return 1;
+}
+
+int ceu_io_read (int fd, tceu_vector* buf) {
+    int ret = ceu_io_check(fd);
+    if (ret != 0) {
+        return ret;
+    } else if (buf->is_ring || buf->unit!=1 || CEU_IO_FDS[fd].rd!=NULL) {
+        return -EINVAL;
+    }
+    tceu_io* io = &CEU_IO_FDS[fd];
+    io->rd      = buf;
+    io->rd_done = 0;
+    if (!io->rd_empty && ceu_io_recv(fd)) {
+        ceu_io_done(fd);
+        return 0;
+    }
+    ret = ceu_io_sync(fd, 0);
+    if (ret!=0 && io->rd_empty && ceu_io_recv(fd)) {
+        ret = 0;    /* not pollable (e.g., a regular file after a short read) */
+        ceu_io_done(fd);
+    } else if (ret != 0) {
+        io->rd = NULL;
+    }
+    return ret;
+}
+
+int ceu_io_write (int fd, tceu_vector* buf) {
+    int ret = ceu_io_check(fd);
+    if (ret != 0) {
+        return ret;
+    } else if (buf->is_ring || buf->unit!=1 || CEU_IO_FDS[fd].wr!=NULL) {
+        return -EINVAL;
+    }
+    tceu_io* io = &CEU_IO_FDS[fd];
+    io->wr     = buf;
+    io->wr_i   = 0;
+    io->wr_err = 0;
+    if (ceu_io_send(fd)) {
+        ceu_io_done(fd);
+    } else {
+        ret = ceu_io_sync(fd, 0);
+        if (ret != 0) {
+            io->wr = NULL;
+        }
+    }
+    return ret;
+}
+
+int ceu_io_accept (int fd) {
+    int ret = ceu_io_check(fd);
+    if (ret != 0) {
+        return ret;
+    } else if (CEU_IO_FDS[fd].accept) {
+        return -EINVAL;
+    }
+    CEU_IO_FDS[fd].accept = 1;
+    ret = ceu_io_sync(fd, 0);
+    if (ret != 0) {
+        CEU_IO_FDS[fd].accept = 0;
+    }
+    return ret;
+}
+
+void ceu_io_cancel (int fd, int kind) {
+    if (fd<0 || fd>=CEU_IO_MAX) {
+        return;
+    }
+    tceu_io* io = &CEU_IO_FDS[fd];
+    if (kind & CEU_IO_READ) {
+        io->rd = NULL;
+    }
+    if (kind & CEU_IO_WRITE) {
+        io->wr = NULL;
+    }
+    if (kind & CEU_IO_ACCEPT) {
+        io->accept = 0;
+    }
+}
+
+int ceu_io_close (int fd) {
+    if (fd>=0 && fd<CEU_IO_MAX && CEU_IO_EP!=-1) {
+        ceu_io_cancel(fd, CEU_IO_ALL);
+        ceu_io_sync(fd, 1);
+    }
+    return close(fd);
+}
+
+int ceu_io_nonblock (int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags==-1 || fcntl(fd, F_SETFL, flags|O_NONBLOCK)==-1) {
+        return -errno;
+    }
+    return 0;
+}
+
+static void ceu_io_emit (tceu_nevt id, int fd, int n) {
+    tceu_input_IO_READ ps = { fd, n };  /* all inputs are "(int,int)" */
+    ceu_input(id, &ps);
+}
+
+static void ceu_io_received (int fd) {
+    tceu_io* io = &CEU_IO_FDS[fd];
+    ssize_t n = io->rd_n;
+    if (n > 0) {
+        io->rd->len += n;
+    }
+    io->rd      = NULL;
+    io->rd_done = 0;
+    if (n > 0) {
+        ceu_io_emit(CEU_INPUT_IO_READ, fd, n);
+    } else {
+        ceu_io_emit(CEU_INPUT_IO_CLOSE, fd, -n);
+    }
+}
+
+static void ceu_io_written (int fd) {
+    tceu_io* io = &CEU_IO_FDS[fd];
+    int err = io->wr_err;
+    io->wr = NULL;
+    if (err == -1) {
+        ceu_io_emit(CEU_INPUT_IO_WRITE, fd, io->wr_i);
+    } else {
+        ceu_io_emit(CEU_INPUT_IO_CLOSE, fd, err);
+    }
+}
+
+static void ceu_io_ready (int fd, u32 events) {
+    tceu_io* io = &CEU_IO_FDS[fd];
+    if (events & (EPOLLIN|EPOLLHUP|EPOLLERR)) {
+        io->rd_empty = 0;
+    }
+
+    if (io->accept && (events & (EPOLLIN|EPOLLHUP|EPOLLERR))) {
+        int c = accept(fd, NULL, NULL);
+        if (!CEU_IO_AGAIN(c)) {
+            io->accept = 0;
+            if (c == -1) {
+                ceu_io_emit(CEU_INPUT_IO_CLOSE, fd, errno);
+            } else {
+                if (c < CEU_IO_MAX) {
+                    /* "c" may reuse an "fd" closed without "ceu_io_close" */
+                    memset(&CEU_IO_FDS[c], 0, sizeof(tceu_io));
+                }
+                fcntl(c, F_SETFD, FD_CLOEXEC);
+                ceu_io_nonblock(c);
+                ceu_io_emit(CEU_INPUT_IO_ACCEPT, fd, c);
+            }
+            if (CEU_APP.end_ok) {
+                return;
+            }
+        }
+    }
+
+    if (io->rd!=NULL && !io->rd_done && (events & (EPOLLIN|EPOLLHUP|EPOLLERR))) {
+        if (ceu_io_recv(fd)) {
+            ceu_io_received(fd);
+            if (CEU_APP.end_ok) {
+                return;
+            }
+        }
+    }
+
+    if (io->wr!=NULL && io->wr_err==0 && (events & (EPOLLOUT|EPOLLHUP|EPOLLERR))) {
+        if (ceu_io_send(fd)) {
+            ceu_io_written(fd);
+            if (CEU_APP.end_ok) {
+                return;
+            }
+        }
+    }
+
+    /* unwanted events would wake up every "epoll_wait" */
+    if ( ((events & EPOLLIN)  && (io->rd==NULL || io->rd_done) && !io->accept) ||
+         ((events & EPOLLOUT) && (io->wr==NULL || io->wr_err!=0)) ) {
+        ceu_io_sync(fd, 1);
+    }
+}
+
+static void ceu_io_start (void) {
+    memset(CEU_IO_FDS, 0, sizeof(CEU_IO_FDS));
+    CEU_IO_DONE_N = 0;
+    CEU_IO_EP = epoll_create1(EPOLL_CLOEXEC);
+#ifdef CEU_WCLOCK_REAL
+    if (CEU_WCLOCK_FD != -1) {
+        struct epoll_event ev;
+        ev.events  = EPOLLIN;
+        ev.data.fd = CEU_WCLOCK_FD;
+        epoll_ctl(CEU_IO_EP, EPOLL_CTL_ADD, CEU_WCLOCK_FD, &ev);
+    }
+#endif
+}
+
+static void ceu_io_stop (void) {
+    close(CEU_IO_EP);
+    CEU_IO_EP = -1;
+}
+
+static void ceu_io_step (void) {
+    int i, n;
+
+    /* requests completed in previous reactions (new ones go to the next step) */
+    n = CEU_IO_DONE_N;
+    for (i=0; i<n && !CEU_APP.end_ok; i++) {
+        int fd = CEU_IO_DONE[i];
+        tceu_io* io = &CEU_IO_FDS[fd];
+        io->queued = 0;
+        if (io->rd!=NULL && io->rd_done) {
+            ceu_io_received(fd);
+        }
+        if (!CEU_APP.end_ok && io->wr!=NULL && io->wr_err!=0) {
+            ceu_io_written(fd);
+        }
+    }
+    memmove(&CEU_IO_DONE[0], &CEU_IO_DONE[n], (CEU_IO_DONE_N-n)*sizeof(int));
+    CEU_IO_DONE_N -= n;
+    if (CEU_APP.end_ok) {
+        return;
+    }
+
+    /* with an "async" or a completed write pending, only polls, otherwise
+     * waits for the next "fd" or timer ("CEU_WCLOCK_FD" expired) */
+    int timeout = (CEU_APP.async_pending || CEU_IO_DONE_N>0) ? 0 : -1;
+#ifdef CEU_FEATURES_THREAD
+    if (CEU_APP.threads_head != NULL) {
+        timeout = 0;
+    }
+#endif
+#ifdef CEU_PAR
+    static bool par_polled = 0;     /* "CEU_PAR_FD" is created on demand */
+    if (CEU_PAR_FD!=-1 && !par_polled) {
+        struct epoll_event ev;
+        ev.events  = EPOLLIN;
+        ev.data.fd = CEU_PAR_FD;
+        epoll_ctl(CEU_IO_EP, EPOLL_CTL_ADD, CEU_PAR_FD, &ev);
+        par_polled = 1;
+    }
+#endif
+    struct epoll_event evs[CEU_IO_EVENTS];
+    n = epoll_wait(CEU_IO_EP, evs, CEU_IO_EVENTS, timeout);
+    for (i=0; i<n && !CEU_APP.end_ok; i++) {
+#ifdef CEU_WCLOCK_REAL
+        if (evs[i].data.fd == CEU_WCLOCK_FD) {
+            u64 v;
+            ssize_t ret = read(CEU_WCLOCK_FD, &v, sizeof(v));
+            (void) ret;
+            continue;
+        }
+#endif
+#ifdef CEU_PAR
+        if (evs[i].data.fd == CEU_PAR_FD) {
+            /* jobs: see "ceu_par_step", which does not read while idle, but
+             * a late wakeup (e.g., after "ceu_par_join") must not spin here */
+            if (CEU_PAR_N == 0) {
+                u64 v;
+                ssize_t ret = read(CEU_PAR_FD, &v, sizeof(v));
+                (void) ret;
+            }
+            continue;
+        }
+#endif
+        ceu_io_ready(evs[i].data.fd, evs[i].events);
+    }
+}
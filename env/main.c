@@ -1,6 +1,34 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#if !defined(CEU_TESTS) && !defined(CEU_WCLOCK_NONE)
+#define CEU_WCLOCK_REAL
+#endif
+
+#ifdef CEU_FEATURES_STATS
+#include <time.h>
+#endif
+
+/* drivers, each in its own file next to this one (see "--env-main") */
+#ifdef CEU_PAR
+#include "par.h"
+#endif
+#ifdef CEU_WCLOCK_REAL
+#include "wclock.h"
+#endif
+#ifdef CEU_IO
+#include "io.h"
+#endif
+#ifdef CEU_FEATURES_RECORD
+#include "record.h"
+#endif
+#ifdef CEU_FEATURES_HITS
+#include "hits.h"
+#endif
+#ifdef CEU_FEATURES_SNAPSHOT
+#include "snapshot.h"
+#endif
+
 int ceu_callback_ceu (int cmd, tceu_callback_val p1, tceu_callback_val p2
 #ifdef CEU_FEATURES_TRACE
                      , tceu_trace trace
@@ -9,11 +37,66 @@ int ceu_callback_ceu (int cmd, tceu_callback_val p1, tceu_callback_val p2
 {
     int is_handled;
 
+#ifdef CEU_FEATURES_SNAPSHOT
+    if (cmd==CEU_CALLBACK_STEP && CEU_SNAPSHOT_FILE!=NULL) {
+        ceu_snapshot_step();    /* then handled below */
+    }
+#endif
+#ifdef CEU_PAR
+    if (cmd == CEU_CALLBACK_STEP) {
+        ceu_par_step();         /* then handled below */
+        if (CEU_APP.end_ok) {
+            return 1;
+        }
+    } else if (cmd == CEU_CALLBACK_STOP) {
+        ceu_par_stop();
+    }
+#endif
+
     switch (cmd) {
+#if defined(CEU_WCLOCK_REAL) || defined(CEU_IO)
+        case CEU_CALLBACK_START:
+            is_handled = 1;
+#ifdef CEU_WCLOCK_REAL
+            ceu_wclock_start();
+#endif
+#ifdef CEU_IO
+            ceu_io_start();
+#endif
+            break;
+        case CEU_CALLBACK_STOP:
+            is_handled = 1;
+#ifdef CEU_IO
+            ceu_io_stop();
+#endif
+#ifdef CEU_WCLOCK_REAL
+            ceu_wclock_stop();
+#endif
+            break;
+        case CEU_CALLBACK_STEP:
+            is_handled = 1;
+#ifdef CEU_IO
+            ceu_io_step();
+#else
+            ceu_wclock_step();
+#endif
+            break;
+#endif
+#ifdef CEU_WCLOCK_REAL
+        case CEU_CALLBACK_WCLOCK_DT:
+            is_handled = 1;
+            ceu_callback_ret.num = ceu_wclock_dt();
+            break;
+        case CEU_CALLBACK_WCLOCK_MIN:
+            is_handled = 1;
+            ceu_wclock_min(p1.num);
+            break;
+#else
         case CEU_CALLBACK_WCLOCK_DT:
             is_handled = 1;
             ceu_callback_ret.num = CEU_WCLOCK_INACTIVE;
             break;
+#endif
         case CEU_CALLBACK_ABORT:
             is_handled = 1;
             abort();
@@ -52,6 +135,29 @@ int ceu_callback_ceu (int cmd, tceu_callback_val p1, tceu_callback_val p2
             is_handled = 1;
             ceu_callback_ret.ptr = realloc(p1.ptr, p2.size);
             break;
+#ifdef CEU_FEATURES_STATS
+        case CEU_CALLBACK_CLOCK: {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            is_handled = 1;
+            ceu_callback_ret.size = (usize)ts.tv_sec*1000000 + ts.tv_nsec/1000;  /* us */
+            break;
+        }
+#endif
+#ifdef CEU_FEATURES_RECORD
+        case CEU_CALLBACK_RECORD:
+            is_handled = 1;
+            if (CEU_RECORD_F != NULL) {
+                ceu_record((tceu_record*)p2.ptr);
+            }
+            break;
+#endif
+#ifdef CEU_FEATURES_SNAPSHOT
+        case CEU_CALLBACK_SNAPSHOT:
+            is_handled = 1;
+            ceu_callback_ret.ptr = (CEU_SNAPSHOT_FILE == NULL) ? NULL : ceu_snapshot_load();
+            break;
+#endif
         default:
             is_handled = 0;
     }
@@ -61,11 +167,26 @@ int ceu_callback_ceu (int cmd, tceu_callback_val p1, tceu_callback_val p2
 int main (int argc, char* argv[])
 {
     tceu_callback cb = { &ceu_callback_ceu, NULL };
+#ifdef CEU_FEATURES_RECORD
+    ceu_record_start();
+#endif
+#ifdef CEU_FEATURES_SNAPSHOT
+    ceu_snapshot_start();
+#endif
+#ifdef CEU_FEATURES_HITS
+    ceu_hits_start();
+#endif
 #ifdef CEU_CALLBACK_ENV
     CEU_CALLBACK_ENV.nxt = &cb;
     int ret = ceu_loop(&CEU_CALLBACK_ENV, argc, argv);
 #else
     int ret = ceu_loop(&cb, argc, argv);
+#endif
+#ifdef CEU_FEATURES_RECORD
+    ceu_record_stop();
+#endif
+#ifdef CEU_FEATURES_HITS
+    ceu_hits_stop();
 #endif
     return ret;
 }
@@ -0,0 +1,233 @@
+/* "env/main.c" with "CEU_PAR" */
+
+#ifndef __linux__
+#error "include/par.ceu" requires "eventfd" (Linux)
+#endif
+#if defined(CEU_STACK_MAX) || defined(CEU_FEATURES_HITS)
+#error "include/par.ceu" runs kernels in worker threads (stack checks and hit counters are not thread safe)
+#endif
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <time.h>
+
+/*
+ * Worker threads of "include/par.ceu":
+ *  - "ceu_par_for" splits a job in chunks of at least "CEU_PAR_GRAIN"
+ *    elements (about four per worker), taken in order by the workers
+ *  - the last chunk of a job wakes up the loop ("CEU_PAR_FD", an "eventfd"),
+ *    which emits "PAR_DONE(id)" on the next step ("ceu_par_step")
+ *  - "CEU_PAR_MUTEX" protects "CEU_PAR_JOBS", but not the vectors, which
+ *    belong to the workers until the job is done
+ */
+#ifndef CEU_PAR_MAX
+#define CEU_PAR_MAX     64      /* jobs in flight */
+#endif
+#ifndef CEU_PAR_GRAIN
+#define CEU_PAR_GRAIN   1024    /* elements per chunk (minimum) */
+#endif
+#ifndef CEU_PAR_THREADS
+#define CEU_PAR_THREADS 64      /* workers (maximum) */
+#endif
+
+typedef struct tceu_par {
+    int        id;          /* 0: free slot */
+    tceu_par_f f;
+    byte*      buf;
+    void*      arg;
+    usize      len;
+    usize      chunk;
+    usize      nxt;         /* first element not taken */
+    usize      left;        /* chunks not finished */
+} tceu_par;
+
+static tceu_par        CEU_PAR_JOBS[CEU_PAR_MAX];
+static int             CEU_PAR_N   = 0;     /* jobs in flight (not emitted) */
+static int             CEU_PAR_IDS = 0;
+static int             CEU_PAR_FD  = -1;
+static pthread_t       CEU_PAR_WORKERS[CEU_PAR_THREADS];
+static int             CEU_PAR_WORKERS_N = 0;
+static bool            CEU_PAR_STOP = 0;
+static pthread_mutex_t CEU_PAR_MUTEX = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  CEU_PAR_TODO  = PTHREAD_COND_INITIALIZER;   /* chunks to take */
+static pthread_cond_t  CEU_PAR_DONE  = PTHREAD_COND_INITIALIZER;   /* jobs finished */
+
+static tceu_par* ceu_par_next (void) {
+    int i;
+    for (i=0; i<CEU_PAR_MAX; i++) {
+        tceu_par* job = &CEU_PAR_JOBS[i];
+        if (job->id!=0 && job->nxt<job->len) {
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static void* ceu_par_worker (void* _) {
+    pthread_mutex_lock(&CEU_PAR_MUTEX);
+    while (1) {
+        tceu_par* job = ceu_par_next();
+        if (job == NULL) {
+            if (CEU_PAR_STOP) {
+                break;
+            }
+            pthread_cond_wait(&CEU_PAR_TODO, &CEU_PAR_MUTEX);
+            continue;
+        }
+        usize i0 = job->nxt;
+        usize i1 = (job->len-i0 > job->chunk) ? i0+job->chunk : job->len;
+        job->nxt = i1;
+        pthread_mutex_unlock(&CEU_PAR_MUTEX);
+        job->f(job->buf, i0, i1, job->arg);
+        pthread_mutex_lock(&CEU_PAR_MUTEX);
+        if (--job->left == 0) {
+            u64 v = 1;
+            ssize_t ret = write(CEU_PAR_FD, &v, sizeof(v));
+            (void) ret;
+            pthread_cond_broadcast(&CEU_PAR_DONE);
+        }
+    }
+    pthread_mutex_unlock(&CEU_PAR_MUTEX);
+    return NULL;
+}
+
+static void ceu_par_start (void) {
+    char* env = getenv("CEU_PAR_WORKERS");
+    int n = (env == NULL) ? (int)sysconf(_SC_NPROCESSORS_ONLN) : atoi(env);
+    if (n < 1) {
+        n = 1;
+    } else if (n > CEU_PAR_THREADS) {
+        n = CEU_PAR_THREADS;
+    }
+    CEU_PAR_FD = eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK);
+    for (CEU_PAR_WORKERS_N=0; CEU_PAR_WORKERS_N<n; CEU_PAR_WORKERS_N++) {
+        if (pthread_create(&CEU_PAR_WORKERS[CEU_PAR_WORKERS_N], NULL, ceu_par_worker, NULL) != 0) {
+            break;
+        }
+    }
+    ceu_assert_sys(CEU_PAR_FD!=-1 && CEU_PAR_WORKERS_N>0, "par: cannot start workers");
+}
+
+static void ceu_par_stop (void) {
+    int i;
+    pthread_mutex_lock(&CEU_PAR_MUTEX);
+    CEU_PAR_STOP = 1;       /* after the chunks in flight */
+    pthread_cond_broadcast(&CEU_PAR_TODO);
+    pthread_mutex_unlock(&CEU_PAR_MUTEX);
+    for (i=0; i<CEU_PAR_WORKERS_N; i++) {
+        pthread_join(CEU_PAR_WORKERS[i], NULL);
+    }
+    CEU_PAR_WORKERS_N = 0;
+    if (CEU_PAR_FD != -1) {
+        close(CEU_PAR_FD);
+        CEU_PAR_FD = -1;
+    }
+}
+
+int ceu_par_for (tceu_vector* vec, tceu_par_f f, void* arg) {
+    int i;
+    if (vec->is_ring) {
+        return -EINVAL;
+    }
+    if (CEU_PAR_WORKERS_N == 0) {
+        ceu_par_start();
+    }
+    pthread_mutex_lock(&CEU_PAR_MUTEX);
+    for (i=0; i<CEU_PAR_MAX && CEU_PAR_JOBS[i].id!=0; i++);
+    if (i == CEU_PAR_MAX) {
+        pthread_mutex_unlock(&CEU_PAR_MUTEX);
+        return -EAGAIN;
+    }
+    tceu_par* job = &CEU_PAR_JOBS[i];
+    usize n = CEU_PAR_WORKERS_N * 4;
+    job->id    = (CEU_PAR_IDS == 0x7FFFFFFF) ? 1 : CEU_PAR_IDS+1;
+    job->f     = f;
+    job->buf   = vec->buf;
+    job->arg   = arg;
+    job->len   = vec->len;
+    job->chunk = (job->len + n-1) / n;
+    if (job->chunk < CEU_PAR_GRAIN) {
+        job->chunk = CEU_PAR_GRAIN;
+    }
+    job->nxt   = 0;
+    job->left  = (job->len + job->chunk-1) / job->chunk;
+    CEU_PAR_IDS = job->id;
+    CEU_PAR_N++;
+    if (job->left == 0) {
+        u64 v = 1;      /* empty vector: done on the next step */
+        ssize_t ret = write(CEU_PAR_FD, &v, sizeof(v));
+        (void) ret;
+    } else {
+        pthread_cond_broadcast(&CEU_PAR_TODO);
+    }
+    pthread_mutex_unlock(&CEU_PAR_MUTEX);
+    return job->id;
+}
+
+void ceu_par_join (int id) {
+    int i;
+    if (id <= 0) {
+        return;
+    }
+    pthread_mutex_lock(&CEU_PAR_MUTEX);
+    for (i=0; i<CEU_PAR_MAX; i++) {
+        tceu_par* job = &CEU_PAR_JOBS[i];
+        if (job->id == id) {
+            /* drops the chunks not taken, waits for the others */
+            job->left -= (job->len - job->nxt + job->chunk-1) / job->chunk;
+            job->len   = job->nxt;
+            while (job->left > 0) {
+                pthread_cond_wait(&CEU_PAR_DONE, &CEU_PAR_MUTEX);
+            }
+            job->id = 0;
+            CEU_PAR_N--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&CEU_PAR_MUTEX);
+}
+
+/* emits "PAR_DONE" for the finished jobs */
+static void ceu_par_step (void) {
+    int ids[CEU_PAR_MAX];
+    int i, n = 0;
+    if (CEU_PAR_N == 0) {
+        return;     /* no syscall while idle ("CEU_PAR_N" belongs to this thread) */
+    }
+    u64 v;
+    ssize_t ret = read(CEU_PAR_FD, &v, sizeof(v));   /* before the jobs: no lost wakeups */
+    (void) ret;
+    pthread_mutex_lock(&CEU_PAR_MUTEX);
+    for (i=0; i<CEU_PAR_MAX; i++) {
+        tceu_par* job = &CEU_PAR_JOBS[i];
+        if (job->id!=0 && job->left==0) {
+            ids[n++] = job->id;
+            job->id = 0;
+        }
+    }
+    CEU_PAR_N -= n;
+    pthread_mutex_unlock(&CEU_PAR_MUTEX);
+    for (i=0; i<n && !CEU_APP.end_ok; i++) {
+        ceu_input(CEU_INPUT_PAR_DONE, &ids[i]);
+    }
+}
+
+#ifdef CEU_WCLOCK_REAL
+/* with jobs in flight, sleeps until one finishes or the "deadline" */
+static void ceu_par_wait (struct timespec* deadline) {
+    struct pollfd p = { CEU_PAR_FD, POLLIN, 0 };
+    int ms = -1;
+    if (deadline != NULL) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        s64 ns = ((s64)(deadline->tv_sec-now.tv_sec))*1000000000 + (deadline->tv_nsec-now.tv_nsec);
+        if (ns <= 0) {
+            return;
+        }
+        ms = (int)((ns+999999) / 1000000);
+    }
+    poll(&p, 1, ms);
+}
+#endif
@@ -0,0 +1,47 @@
+/* "env/main.c" with "CEU_FEATURES_RECORD" */
+
+/*
+ * `CEU_RECORD=<file>`: records every "ceu_input" to be replayed with
+ * "env/replay.c".
+ * The file is "CEUR" and a version byte, followed by one record per input:
+ *      <id> <dt> <size> <params...>
+ * The first three fields are LEB128 varints, and "dt" is "0" for
+ * "CEU_WCLOCK_INACTIVE" or "dt+1" otherwise.
+ * Each record is flushed before the input reacts, so that the file covers
+ * the inputs up to a crash (which is what one usually replays).
+ */
+static FILE* CEU_RECORD_F = NULL;
+
+static void ceu_record_varint (u32 v) {
+    while (v >= 0x80) {
+        fputc((v & 0x7F) | 0x80, CEU_RECORD_F);
+        v >>= 7;
+    }
+    fputc(v, CEU_RECORD_F);
+}
+
+static void ceu_record (tceu_record* rec) {
+    ceu_record_varint(rec->id);
+    ceu_record_varint((rec->dt == CEU_WCLOCK_INACTIVE) ? 0 : (u32)rec->dt+1);
+    ceu_record_varint(rec->size);
+    fwrite(rec->params, 1, rec->size, CEU_RECORD_F);
+    fflush(CEU_RECORD_F);
+}
+
+static void ceu_record_start (void) {
+    char* record = getenv("CEU_RECORD");
+    if (record != NULL) {
+        CEU_RECORD_F = fopen(record, "wb");
+        if (CEU_RECORD_F == NULL) {
+            perror(record);
+            exit(EXIT_FAILURE);
+        }
+        fwrite("CEUR\x01", 1, 5, CEU_RECORD_F);
+    }
+}
+
+static void ceu_record_stop (void) {
+    if (CEU_RECORD_F != NULL) {
+        fclose(CEU_RECORD_F);
+    }
+}
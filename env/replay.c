@@ -0,0 +1,132 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Replays a file recorded by "env/main.c" with `CEU_RECORD=<file>`
+ * (`--ceu-features-record`), at full speed:
+ *
+ *  $ ceu ... --env-main=env/replay.c ...
+ *  $ CEU_REPLAY=<file> ./app
+ *
+ * The program must be the same binary that recorded the file.
+ * Outputs are handled as in "env/main.c", and `async/thread` and
+ * `async/isr` are not reproducible.
+ * Reports the number of inputs and the time to replay them to stderr.
+ */
+
+static s32   CEU_REPLAY_DT;
+static FILE* CEU_REPLAY_F;
+
+int ceu_callback_replay (int cmd, tceu_callback_val p1, tceu_callback_val p2
+#ifdef CEU_FEATURES_TRACE
+                        , tceu_trace trace
+#endif
+                        )
+{
+    int is_handled;
+
+    switch (cmd) {
+        case CEU_CALLBACK_WCLOCK_DT:
+            is_handled = 1;
+            ceu_callback_ret.num = CEU_REPLAY_DT;
+            break;
+        case CEU_CALLBACK_ABORT:
+            is_handled = 1;
+            abort();
+            break;
+        case CEU_CALLBACK_LOG: {
+            is_handled = 1;
+            switch (p1.num) {
+                case 0:
+                    printf("%s", (char*)p2.ptr);
+                    break;
+                case 1:
+                    printf("%p", p2.ptr);
+                    break;
+                case 2:
+                    printf("%d", p2.num);
+                    break;
+            }
+            break;
+        }
+        case CEU_CALLBACK_REALLOC:
+            is_handled = 1;
+            ceu_callback_ret.ptr = realloc(p1.ptr, p2.size);
+            break;
+        default:
+            is_handled = 0;
+    }
+    return is_handled;
+}
+
+static int ceu_replay_varint (u32* v) {
+    int c, i = 0;
+    *v = 0;
+    do {
+        c = fgetc(CEU_REPLAY_F);
+        if (c == EOF) {
+            return 0;
+        }
+        *v |= ((u32)(c & 0x7F)) << (7*i++);
+    } while (c & 0x80);
+    return 1;
+}
+
+int main (int argc, char* argv[])
+{
+    char* replay = getenv("CEU_REPLAY");
+    if (replay == NULL) {
+        fprintf(stderr, "usage: CEU_REPLAY=<file> %s\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    CEU_REPLAY_F = fopen(replay, "rb");
+    if (CEU_REPLAY_F == NULL) {
+        perror(replay);
+        exit(EXIT_FAILURE);
+    }
+    {
+        char magic[5];
+        if (fread(magic,1,5,CEU_REPLAY_F)!=5 || memcmp(magic,"CEUR\x01",5)!=0) {
+            fprintf(stderr, "%s: invalid record file\n", replay);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    tceu_callback cb = { &ceu_callback_replay, NULL };
+    struct timespec t0, t1;
+    u8*   buf = NULL;
+    usize max = 0;
+    u32   n   = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    ceu_start(&cb, argc, argv);
+    while (!CEU_APP.end_ok) {
+        u32 id, dt, size;
+        if (!ceu_replay_varint(&id) || !ceu_replay_varint(&dt) || !ceu_replay_varint(&size)) {
+            break;
+        }
+        if (size > max) {
+            max = size;
+            buf = (u8*) realloc(buf, max);
+        }
+        if (fread(buf, 1, size, CEU_REPLAY_F) != size) {
+            break;
+        }
+        CEU_REPLAY_DT = (dt == 0) ? CEU_WCLOCK_INACTIVE : (s32)(dt-1);
+        ceu_input(id, (size == 0) ? NULL : buf);
+        n++;
+    }
+    ceu_stop();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    u64 ns = (t1.tv_sec-t0.tv_sec)*1000000000LL + (t1.tv_nsec-t0.tv_nsec);
+    fprintf(stderr, "replay: %lu inputs in %llu ns (%.0f inputs/s)%s\n",
+            (unsigned long) n, (unsigned long long) ns, (ns==0) ? 0 : n*1e9/ns,
+            CEU_APP.end_ok ? "" : " (program did not terminate)");
+
+    free(buf);
+    fclose(CEU_REPLAY_F);
+    return CEU_APP.end_val;
+}
@@ -0,0 +1,78 @@
+/* "env/main.c" with "CEU_FEATURES_SNAPSHOT" */
+
+#include <signal.h>
+#include <string.h>
+
+/*
+ * `CEU_SNAPSHOT=<file>`: restores the program from <file> instead of starting
+ * it (if <file> exists and matches the binary), and saves the program to
+ * <file> on the next step after each "SIGUSR1" (e.g., before a restart).
+ * Across runs, the binary must load at the same addresses (e.g., "-no-pie"),
+ * otherwise the image is rejected (see "ceu_snapshot_restore").
+ * The file is the "tceu_snapshot" followed by the image.
+ */
+static char*                 CEU_SNAPSHOT_FILE = NULL;
+static volatile sig_atomic_t CEU_SNAPSHOT_REQ  = 0;
+static tceu_snapshot         CEU_SNAPSHOT;
+
+static void ceu_snapshot_signal (int sig) {
+    CEU_SNAPSHOT_REQ = 1;
+}
+
+static void* ceu_snapshot_load (void) {
+    void* ret = NULL;
+    tceu_snapshot snap;
+    FILE* f = fopen(CEU_SNAPSHOT_FILE, "rb");
+    if (f == NULL) {
+        return NULL;    /* first run */
+    }
+    if (fread(&snap, sizeof(snap), 1, f) == 1 && snap.size == sizeof(CEU_APP)) {
+        snap.image = malloc(snap.size);     /* see "ceu_snapshot_step" */
+        if (snap.image != NULL) {
+            if (fread(snap.image, snap.size, 1, f) == 1) {
+                CEU_SNAPSHOT = snap;
+                ret = &CEU_SNAPSHOT;
+            } else {
+                free(snap.image);
+            }
+        }
+    }
+    fclose(f);
+    return ret;     /* NULL or rejected: cold start */
+}
+
+/* between reactions */
+static void ceu_snapshot_step (void) {
+    if (CEU_SNAPSHOT.image!=NULL && CEU_SNAPSHOT.image!=&CEU_APP) {
+        free(CEU_SNAPSHOT.image);   /* restored from */
+        CEU_SNAPSHOT.image = NULL;
+    }
+    if (!CEU_SNAPSHOT_REQ) {
+        return;
+    }
+    CEU_SNAPSHOT_REQ = 0;
+
+    /* "<file>.tmp" renamed over <file>: never a partial snapshot */
+    char tmp[strlen(CEU_SNAPSHOT_FILE)+5];
+    strcpy(tmp, CEU_SNAPSHOT_FILE);
+    strcat(tmp, ".tmp");
+    FILE* f = fopen(tmp, "wb");
+    if (f == NULL) {
+        perror(tmp);
+        return;
+    }
+    ceu_snapshot_save(&CEU_SNAPSHOT);
+    int ok = (fwrite(&CEU_SNAPSHOT, sizeof(CEU_SNAPSHOT), 1, f) == 1 &&
+              fwrite(CEU_SNAPSHOT.image, CEU_SNAPSHOT.size, 1, f) == 1);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp,CEU_SNAPSHOT_FILE)!=0) {
+        perror(CEU_SNAPSHOT_FILE);
+    }
+}
+
+static void ceu_snapshot_start (void) {
+    CEU_SNAPSHOT_FILE = getenv("CEU_SNAPSHOT");
+    if (CEU_SNAPSHOT_FILE != NULL) {
+        signal(SIGUSR1, ceu_snapshot_signal);
+    }
+}
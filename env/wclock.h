@@ -0,0 +1,129 @@
+/* "env/main.c" with "CEU_WCLOCK_REAL" (after "par.h") */
+
+#include <time.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/timerfd.h>
+#endif
+
+/*
+ * Wall clock ("CLOCK_MONOTONIC"), unless "-DCEU_WCLOCK_NONE" (or in the tests):
+ *  - "CEU_CALLBACK_WCLOCK_DT": microseconds since the previous "dt", carrying
+ *    the remaining nanoseconds, so that all "dt"s add up to the real time and
+ *    the runtime compensates late timers ("wclk_late") without drifting
+ *  - "CEU_CALLBACK_WCLOCK_MIN": deadline of the next timer, which also arms
+ *    "CEU_WCLOCK_FD" ("timerfd" on Linux, for loops that poll other fds)
+ *  - "CEU_CALLBACK_STEP": with no "async" pending, sleeps until the deadline
+ */
+static struct timespec CEU_WCLOCK_NOW;      /* time of the previous "dt" */
+static struct timespec CEU_WCLOCK_NXT;      /* deadline of the next timer */
+static bool            CEU_WCLOCK_ARMED = 0;
+#ifdef __linux__
+int CEU_WCLOCK_FD = -1;
+#endif
+
+static s64 ceu_wclock_ns (struct timespec* t1, struct timespec* t0) {
+    return ((s64)(t1->tv_sec-t0->tv_sec))*1000000000 + (t1->tv_nsec-t0->tv_nsec);
+}
+
+static void ceu_wclock_add (struct timespec* t, s64 ns) {
+    t->tv_sec  += ns / 1000000000;
+    t->tv_nsec += ns % 1000000000;
+    if (t->tv_nsec >= 1000000000) {
+        t->tv_sec++;
+        t->tv_nsec -= 1000000000;
+    } else if (t->tv_nsec < 0) {
+        t->tv_sec--;
+        t->tv_nsec += 1000000000;
+    }
+}
+
+static void ceu_wclock_start (void) {
+    clock_gettime(CLOCK_MONOTONIC, &CEU_WCLOCK_NOW);
+    CEU_WCLOCK_ARMED = 0;
+#ifdef __linux__
+    CEU_WCLOCK_FD = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+#endif
+}
+
+static void ceu_wclock_stop (void) {
+#ifdef __linux__
+    if (CEU_WCLOCK_FD != -1) {
+        close(CEU_WCLOCK_FD);
+        CEU_WCLOCK_FD = -1;
+    }
+#endif
+}
+
+static s32 ceu_wclock_dt (void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (!CEU_WCLOCK_ARMED) {
+        /* no timers: nothing to awake, but new timers start from now */
+        CEU_WCLOCK_NOW = now;
+        return CEU_WCLOCK_INACTIVE;
+    }
+    s64 us = ceu_wclock_ns(&now, &CEU_WCLOCK_NOW) / 1000;
+    if (us > 0x7FFFFFFF) {
+        us = 0x7FFFFFFF;
+    }
+    ceu_wclock_add(&CEU_WCLOCK_NOW, us*1000);
+    return (s32) us;
+}
+
+static void ceu_wclock_min (s32 us) {
+    CEU_WCLOCK_ARMED = (us != CEU_WCLOCK_INACTIVE);
+    if (CEU_WCLOCK_ARMED) {
+        CEU_WCLOCK_NXT = CEU_WCLOCK_NOW;
+        ceu_wclock_add(&CEU_WCLOCK_NXT, ((s64)us)*1000);
+    }
+#ifdef __linux__
+    if (CEU_WCLOCK_FD != -1) {
+        struct itimerspec its = { {0,0}, {0,0} };   /* disarm */
+        if (CEU_WCLOCK_ARMED) {
+            its.it_value = CEU_WCLOCK_NXT;
+        }
+        timerfd_settime(CEU_WCLOCK_FD, TFD_TIMER_ABSTIME, &its, NULL);
+    }
+#endif
+}
+
+static void ceu_wclock_step (void) {
+    if (CEU_APP.async_pending) {
+        return;
+    }
+#ifdef CEU_FEATURES_THREAD
+    if (CEU_APP.threads_head != NULL) {
+        return;
+    }
+#endif
+#ifdef CEU_PAR
+    if (CEU_PAR_N > 0) {
+        ceu_par_wait(CEU_WCLOCK_ARMED ? &CEU_WCLOCK_NXT : NULL);
+        return;
+    }
+#endif
+    if (!CEU_WCLOCK_ARMED) {
+        return;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    s64 ns = ceu_wclock_ns(&CEU_WCLOCK_NXT, &now);
+    if (ns <= 0) {
+        return;
+    }
+#ifdef __linux__
+    if (CEU_WCLOCK_FD != -1) {
+        u64 n;
+        ssize_t ret = read(CEU_WCLOCK_FD, &n, sizeof(n));  /* blocks until the deadline */
+        (void) ret;
+        return;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &CEU_WCLOCK_NXT, NULL);
+#else
+    /* no "clock_nanosleep" (e.g., macOS): relative to "now", an early wake
+     * up only costs one more step */
+    struct timespec rel = { (time_t)(ns / 1000000000), (long)(ns % 1000000000) };
+    nanosleep(&rel, NULL);
+#endif
+}
@@ -1,7 +1,7 @@
 #include <stddef.h>     /* offsetof */
 #include <stdlib.h>     /* NULL */
 #include <string.h>     /* memset, strlen */
-#ifdef CEU_TESTS
+#if defined(CEU_TESTS) || defined(CEU_SIZES)
 #include <stdio.h>
 #endif
 
@@ -32,8 +32,11 @@ typedef u16 tceu_nseq;   /* TODO */
 typedef u8  tceu_nstk;   /* TODO */
 typedef === CEU_TCEU_NTRL === tceu_ntrl;
 typedef === CEU_TCEU_NLBL === tceu_nlbl;
+typedef === CEU_TCEU_NINP === tceu_ninp;
 
 #define CEU_TRAILS_N === CEU_TRAILS_N ===
+#define CEU_UNITS_N  === CEU_UNITS_N ===
+#define CEU_LABELS_N === CEU_LABELS_N ===
 #define CEU_STACK_N 500
 
 #define CEU_API
@@ -42,6 +45,9 @@ CEU_API void ceu_stop  (void);
 CEU_API void ceu_input (tceu_nevt id, void* params);
 CEU_API int  ceu_loop  (tceu_callback* cb, int argc, char* argv[]);
 CEU_API void ceu_callback_register (tceu_callback* cb);
+#ifdef CEU_FEATURES_CALLBACK_TABLE
+CEU_API void ceu_callback_register_cmd (int cmd, tceu_callback_f f);
+#endif
 
 struct tceu_code_mem;
 struct tceu_pool_pak;
@@ -69,6 +75,7 @@ typedef struct tceu_stk {
     usize      params_n;
     bool       is_alive;
     struct tceu_stk* prv;
+    struct tceu_stk* mem_prv;   /* previous frame over "range.mem" (see "ceu_stack_clear") */
 } tceu_stk;
 
 struct tceu_data_Exception;
@@ -108,7 +115,7 @@ typedef struct tceu_code_mem {
     struct tceu_code_mem* up_mem;
     u8          depth;
 #ifdef CEU_FEATURES_TRACE
-    tceu_trace  trace;
+    u32         trace;      /* site that invoked the abstraction (see "tceu_trace") */
 #endif
 #ifdef CEU_FEATURES_EXCEPTION
     tceu_catch* catches;
@@ -117,10 +124,52 @@ typedef struct tceu_code_mem {
     lua_State*  lua;
 #endif
     bool has_term;
+    struct tceu_stk* stk;   /* innermost frame over this memory (see "ceu_stack_clear") */
+#ifdef CEU_INPUT_TABLES
+    tceu_ninp   inputs;     /* row in CEU_INPUTS_IDX (0: scan all trails) */
+#endif
     tceu_ntrl   trails_n;
     tceu_trl    _trails[0];
 } tceu_code_mem;
 
+#ifdef CEU_FEATURES_TRACE
+static const char* CEU_TRACE_FILES[] = {
+    === CEU_TRACE_FILES ===
+};
+
+static void ceu_trace_site (u32 site) {
+    u32 line = site & CEU_TRACE_LINE_MAX;
+    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"[", CEU_TRACE_null);
+    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)CEU_TRACE_FILES[site>>CEU_TRACE_LINE_BITS], CEU_TRACE_null);
+    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)":", CEU_TRACE_null);
+    if (line == CEU_TRACE_LINE_MAX) {
+        ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"?", CEU_TRACE_null);
+    } else {
+        ceu_callback_num_num(CEU_CALLBACK_LOG, 2, line, CEU_TRACE_null);
+    }
+    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"] -> ", CEU_TRACE_null);
+}
+
+/* sites that invoked "mem" and its enclosing abstractions, outermost first */
+static void ceu_trace_up (tceu_code_mem* mem) {
+    if (mem != NULL) {
+        ceu_trace_up(mem->up_mem);
+        if (mem->trace != 0) {
+            ceu_trace_site(mem->trace);
+        }
+    }
+}
+
+static void ceu_trace (tceu_trace trace, const char* msg) {
+    ceu_trace_up(trace.mem);
+    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"\n", CEU_TRACE_null);
+    ceu_trace_site(trace.site);
+    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"runtime error: ", CEU_TRACE_null);
+    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)(msg),             CEU_TRACE_null);
+    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"\n",              CEU_TRACE_null);
+}
+#endif
+
 #ifdef CEU_FEATURES_POOL
 typedef struct tceu_code_mem_dyn {
     struct tceu_code_mem_dyn* prv;
@@ -134,6 +183,11 @@ typedef struct tceu_pool_pak {
     tceu_code_mem_dyn first;
     tceu_code_mem*    up_mem;
     u8                n_traversing;
+    u8                no_fins;      /* instances without finalizers (see "ceu_code_mem_dyn_release") */
+#ifdef CEU_FEATURES_DYNAMIC
+    usize             over_n;       /* instances in the heap (see "ceu_code_mem_dyn_overflow") */
+    usize             over_max;     /* 0: no overflow, "pool[n->max]": max-n, "pool[n->]": -1 */
+#endif
 } tceu_pool_pak;
 #endif
 
@@ -220,6 +274,109 @@ enum {
     === CEU_EXTS_ENUM_OUTPUT ===
 };
 
+#ifdef CEU_FEATURES_STATS
+/*
+ * `--ceu-features-stats`: counters since "ceu_start" (see "ceu_stats")
+ *  - reactions: counted where they start ("ceu_start" as "CEU_INPUT__NONE",
+ *               "ceu_input", and inputs emitted from `async`), not in the
+ *               internal broadcasts (e.g., "CEU_INPUT__CLEAR")
+ *  - latency: reaction times to "ceu_input" in the units of the clock from
+ *             "CEU_CALLBACK_CLOCK" (bucket "i" counts times of "i" bits)
+ *             the clock is a "usize" that may wrap around (only differences
+ *             are used)
+ */
+#ifndef CEU_STATS_LATENCY_N
+#define CEU_STATS_LATENCY_N 24
+#endif
+typedef struct tceu_stats {
+    u32       reactions[CEU_EVENT__MIN];    /* reactions per input ("CEU_INPUT_*") */
+    u32       trails;                       /* trails visited */
+    tceu_nstk level_max;                    /* nested emits */
+    usize     stack_max;                    /* bytes in "CEU_APP.stack" */
+    u32       pool_n;                       /* "code" instances alive in pools */
+    u32       pool_max;
+    u32       pool_overflows;               /* spawns in the heap of "pool[n->max]" */
+    u32       pool_fails;                   /* spawns in full pools */
+    u32       vector_reallocs;
+    u32       latency[CEU_STATS_LATENCY_N];
+} tceu_stats;
+
+CEU_API void ceu_stats (tceu_stats* stats);
+#endif
+
+#ifdef CEU_FEATURES_RECORD
+/*
+ * `--ceu-features-record`: "CEU_CALLBACK_RECORD" receives each "ceu_input"
+ * before it reacts, with all that is needed to replay it (see "env/replay.c")
+ *  - params are copied as raw bytes (pointers are not followed)
+ */
+typedef struct tceu_record {
+    s32       dt;       /* answer to "CEU_CALLBACK_WCLOCK_DT" */
+    tceu_nevt id;
+    usize     size;     /* bytes in "params" */
+    void*     params;
+} tceu_record;
+#endif
+
+#ifdef CEU_FEATURES_OUTPUT_BATCH
+/*
+ * `--ceu-features-output-batch`: outputs without a result are copied to
+ * "CEU_APP.outputs" and passed to the environment at the end of the reaction
+ * in a single "CEU_CALLBACK_OUTPUT_BATCH" (p1.num=n, p2.ptr=tceu_output_batch*)
+ *  - the callback sets "ceu_callback_ret.num=1" if it handled all outputs,
+ *    otherwise each one goes through "CEU_CALLBACK_OUTPUT" in order
+ *  - outputs with a result, with `&` parameters, or with an implementation
+ *    in Ceu are still synchronous (the batch is flushed before them)
+ *  - `&&` parameters are copied as pointers: the contents must remain valid
+ *    until the end of the reaction
+ */
+#ifndef CEU_OUTPUT_BATCH_MAX
+#define CEU_OUTPUT_BATCH_MAX 1024   /* bytes */
+#endif
+typedef struct tceu_output {
+    tceu_nevt id;
+    usize     size;         /* bytes in "params" */
+    u64       params[0];    /* padded to 8 bytes */
+} tceu_output;
+
+#define CEU_OUTPUT_NXT(o) \
+    ((tceu_output*)(((byte*)(o)->params) + (((o)->size+7) & ~((usize)7))))
+
+typedef struct tceu_output_batch {
+    usize n;                                /* outputs in "buf" */
+    usize len;                              /* bytes in "buf" */
+    u64   buf[CEU_OUTPUT_BATCH_MAX/8];      /* first "tceu_output" */
+} tceu_output_batch;
+#endif
+
+#ifdef CEU_FEATURES_SNAPSHOT
+/*
+ * `--ceu-features-snapshot`: the state of the program ("CEU_APP", with the
+ * root, pools and vectors) as an image to be restored in a later run of the
+ * same binary, instead of "ceu_start":
+ *  - "ceu_snapshot_save": only between reactions (e.g., on "CEU_CALLBACK_STEP")
+ *  - "CEU_CALLBACK_SNAPSHOT": asked by "ceu_start", which restores from
+ *    "ceu_callback_ret.ptr" (tceu_snapshot*) unless it is NULL or rejected
+ *  - pointers are not relocated: an image is only restored at the addresses
+ *    it was saved from (the same binary and "&CEU_APP"), otherwise it is
+ *    rejected (e.g., across runs of a position-independent executable with
+ *    address randomization, link with "-no-pie")
+ *  - there is no dynamic memory (`--ceu-features-dynamic`) to follow
+ *  - native globals and resources of the environment (e.g., fds) are not
+ *    part of the image
+ */
+typedef struct tceu_snapshot {
+    u32   hash;     /* "CEU_SNAPSHOT_HASH": generated program and options */
+    usize size;     /* bytes in "image" */
+    usize text;     /* "&CEU_APP" from "ceu_start": same binary */
+    usize app;      /* "&CEU_APP": same addresses */
+    void* image;    /* "&CEU_APP" on save, the bytes to restore on restore */
+} tceu_snapshot;
+
+CEU_API void ceu_snapshot_save    (tceu_snapshot* snap);
+CEU_API int  ceu_snapshot_restore (tceu_snapshot* snap);
+#endif
+
 /* CEU_ISRS_DEFINES */
 
 === CEU_ISRS_DEFINES ===
@@ -256,10 +413,14 @@ static void* ceu_data_as_ (tceu_ndata* supers, tceu_ndata* me, tceu_ndata cmp
 
 /* CEU_DATAS_MEMS */
 
+#ifndef CEU_LAYOUT_ALIGNED
 #pragma pack(push,1)
+#endif
 === CEU_DATAS_MEMS ===
 === CEU_DATAS_MEMS_CASTS ===
+#ifndef CEU_LAYOUT_ALIGNED
 #pragma pack(pop)
+#endif
 
 #ifdef CEU_FEATURES_EXCEPTION
 typedef struct tceu_opt_Exception {
@@ -295,6 +456,10 @@ enum {
     === CEU_LABELS ===
 };
 
+=== CEU_LABELS_LINES ===
+
+=== CEU_INPUTS_DEFINES ===
+
 /*****************************************************************************/
 
 typedef struct tceu_app {
@@ -309,10 +474,19 @@ typedef struct tceu_app {
     tceu_nseq seq_base;
 
     /* CALLBACKS */
-    tceu_callback* cbs;
+    tceu_callback*  cbs;
+#ifdef CEU_FEATURES_CALLBACK_TABLE
+    tceu_callback_f cbs_cmd[CEU_CALLBACK__MAX];     /* tried before "cbs" */
+#endif
+#ifdef CEU_FEATURES_SNAPSHOT
+    tceu_callback*  cbs_env;                        /* "cb" from "ceu_start" */
+#endif
 
     /* ASYNC */
     bool async_pending;
+#ifdef CEU_ASYNC_BUDGET
+    u32  async_budget;      /* iterations left before "async" loops yield */
+#endif
 
     /* WCLOCK */
     s32 wclk_late;
@@ -328,10 +502,24 @@ typedef struct tceu_app {
     byte  stack[CEU_STACK_N];
     usize stack_i;
 
+#ifdef CEU_FEATURES_STATS
+    tceu_stats stats;
+#endif
+
+#ifdef CEU_FEATURES_HITS
+    /* `--ceu-features-hits` (see "CEU_LABELS_LINES" and "--ceu-label-map") */
+    volatile tceu_nlbl lbl_cur;     /* running label (for sampling profilers) */
+    u32 hits[CEU_LABELS_N];         /* dispatches of each label */
+#endif
+
+#ifdef CEU_FEATURES_OUTPUT_BATCH
+    tceu_output_batch outputs;
+#endif
+
     tceu_code_mem_ROOT root;
 } tceu_app;
 
-CEU_API static tceu_app CEU_APP;
+CEU_API CEU_UNIT_GLOBAL tceu_app CEU_APP;
 
 /*****************************************************************************/
 
@@ -390,29 +578,56 @@ static void ceu_params_cpy (tceu_stk* stk, void* params, usize params_n) {
     stk->params   = &CEU_APP.stack[CEU_APP.stack_i];
     stk->params_n = params_n;
     CEU_APP.stack_i += stk->params_n;
+#ifdef CEU_FEATURES_STATS
+    if (CEU_APP.stack_i > CEU_APP.stats.stack_max) {
+        CEU_APP.stats.stack_max = CEU_APP.stack_i;
+    }
+#endif
 }
 
 /*****************************************************************************/
 
-void ceu_stack_clear (tceu_stk* cur, tceu_code_mem* mem) {
-    if (cur == NULL) {
-        return;
-    }
-    if (cur->range.mem == mem) {
-        cur->is_alive = 0;
+void ceu_stack_clear (tceu_code_mem* mem);
+#ifdef CEU_FEATURES_POOL
+void ceu_code_mem_dyn_free (tceu_pool_pak* pak, tceu_code_mem_dyn* cur);
+void ceu_code_mem_dyn_gc (tceu_pool_pak* pak);
+void ceu_code_mem_dyn_release (tceu_pool_pak* pak);
+#ifdef CEU_FEATURES_DYNAMIC
+tceu_code_mem_dyn* ceu_code_mem_dyn_overflow (tceu_pool_pak* pak, usize size);
+#endif
+#endif
+
+#if defined(CEU_UNIT_ALL) || (CEU_UNIT == 0)
+
+/* "mem" is terminating: kills the frames over it, which are linked from
+ * "mem->stk" through "mem_prv" (see "ceu_bcast") */
+void ceu_stack_clear (tceu_code_mem* mem) {
+    tceu_stk* stk = mem->stk;
+    while (stk != NULL) {
+        stk->is_alive = 0;
+        stk = stk->mem_prv;
     }
-    ceu_stack_clear(cur->prv, mem);
+    mem->stk = NULL;
 }
 
 #ifdef CEU_FEATURES_POOL
-void ceu_code_mem_dyn_free (tceu_pool* pool, tceu_code_mem_dyn* cur) {
+void ceu_code_mem_dyn_free (tceu_pool_pak* pak, tceu_code_mem_dyn* cur) {
+    tceu_pool* pool = &pak->pool;
     cur->nxt->prv = cur->prv;
     cur->prv->nxt = cur->nxt;
+#ifdef CEU_FEATURES_STATS
+    CEU_APP.stats.pool_n--;
+#endif
 
 #ifdef CEU_FEATURES_DYNAMIC
     if (pool->queue == NULL) {
         /* dynamic pool */
         ceu_callback_ptr_num(CEU_CALLBACK_REALLOC, cur, 0, CEU_TRACE_null);
+    } else if (pak->over_n>0 && ((byte*)cur < pool->buf ||
+                                 (byte*)cur >= pool->buf + pool->len*pool->unit)) {
+        /* overflow of "pool[n->max]" */
+        pak->over_n--;
+        ceu_callback_ptr_num(CEU_CALLBACK_REALLOC, cur, 0, CEU_TRACE_null);
     } else
 #endif
     {
@@ -430,14 +645,46 @@ void ceu_code_mem_dyn_gc (tceu_pool_pak* pak) {
         while (cur != &pak->first) {
             tceu_code_mem_dyn* nxt = cur->nxt;
             if (!cur->is_alive) {
-                ceu_code_mem_dyn_free(&pak->pool, cur);
+                ceu_code_mem_dyn_free(pak, cur);
             }
             cur = nxt;
         }
     }
 }
+
+#ifdef CEU_FEATURES_DYNAMIC
+/* "pool[n->max]" without free slots: the instance goes to the heap, up to
+ * "over_max" instances (freed in "ceu_code_mem_dyn_free") */
+tceu_code_mem_dyn* ceu_code_mem_dyn_overflow (tceu_pool_pak* pak, usize size) {
+    if (pak->over_n == pak->over_max) {
+        return NULL;
+    }
+    ceu_callback_ptr_num(CEU_CALLBACK_REALLOC, NULL, size, CEU_TRACE_null);
+    if (ceu_callback_ret.ptr != NULL) {
+        pak->over_n++;
+#ifdef CEU_FEATURES_STATS
+        CEU_APP.stats.pool_overflows++;
+#endif
+    }
+    return (tceu_code_mem_dyn*) ceu_callback_ret.ptr;
+}
 #endif
 
+/* CLEAR on a pool of "no_fins": the only effects of aborting its instances
+ * are those of their "Code_Finalize", done here at once */
+void ceu_code_mem_dyn_release (tceu_pool_pak* pak) {
+    tceu_code_mem_dyn* cur = pak->first.nxt;
+    while (cur != &pak->first) {
+        cur->is_alive = 0;
+        ceu_stack_clear(&cur->mem[0]);
+        cur = cur->nxt;
+    }
+    ceu_code_mem_dyn_gc(pak);
+}
+#endif
+
+#endif /* CEU_UNIT == 0 */
+
 /*****************************************************************************/
 
 #ifdef CEU_FEATURES_LUA
@@ -464,7 +711,62 @@ static void ceu_callback (int cmd, tceu_callback_val p1, tceu_callback_val p2
 #endif
                          );
 
-static int ceu_lbl (tceu_nstk _ceu_level, tceu_stk* _ceu_cur, tceu_stk* _ceu_nxt, tceu_code_mem* _ceu_mem, tceu_nlbl _ceu_lbl, tceu_ntrl* _ceu_trlK);
+#ifdef CEU_FEATURES_OUTPUT_BATCH
+static void ceu_output_flush (void) {
+    tceu_output_batch* b = &CEU_APP.outputs;
+    if (b->n == 0) {
+        return;
+    }
+    ceu_callback_ret.num = 0;
+    ceu_callback_num_ptr(CEU_CALLBACK_OUTPUT_BATCH, b->n, b, CEU_TRACE_null);
+    if (!ceu_callback_ret.num) {
+        tceu_output* o = (tceu_output*) b->buf;
+        usize i;
+        for (i=0; i<b->n; i++) {
+            ceu_callback_num_ptr(CEU_CALLBACK_OUTPUT, o->id,
+                                 (o->size==0) ? NULL : o->params, CEU_TRACE_null);
+            o = CEU_OUTPUT_NXT(o);
+        }
+    }
+    b->n   = 0;
+    b->len = 0;
+}
+
+static void ceu_output_batch_ex (tceu_nevt id, void* params, usize size
+#ifdef CEU_FEATURES_TRACE
+                             , tceu_trace trace
+#endif
+                             )
+{
+    tceu_output_batch* b = &CEU_APP.outputs;
+    usize len = sizeof(tceu_output) + ((size+7) & ~((usize)7));
+    if (b->len+len > sizeof(b->buf)) {
+        ceu_output_flush();
+        if (len > sizeof(b->buf)) {
+            ceu_callback_num_ptr(CEU_CALLBACK_OUTPUT, id, params, trace);
+            return;
+        }
+    }
+    {
+        tceu_output* o = (tceu_output*) (((byte*)b->buf) + b->len);
+        o->id   = id;
+        o->size = size;
+        if (size > 0) {
+            memcpy(o->params, params, size);
+        }
+        b->n++;
+        b->len += len;
+    }
+}
+
+#ifdef CEU_FEATURES_TRACE
+#define ceu_output_batch(a,b,c) ceu_output_batch_ex(a,b,c,CEU_TRACE(0))
+#else
+#define ceu_output_batch(a,b,c) ceu_output_batch_ex(a,b,c)
+#endif
+#endif
+
+CEU_UNIT_STATIC int ceu_lbl (tceu_nstk _ceu_level, tceu_stk* _ceu_cur, tceu_stk* _ceu_nxt, tceu_code_mem* _ceu_mem, tceu_nlbl _ceu_lbl, tceu_ntrl* _ceu_trlK);
 
 === CEU_NATIVE_POS ===
 
@@ -476,11 +778,27 @@ static int ceu_lbl (tceu_nstk _ceu_level, tceu_stk* _ceu_cur, tceu_stk* _ceu_nxt
 
 /*****************************************************************************/
 
+#if defined(CEU_UNIT_ALL) || (CEU_UNIT == 0)
 CEU_API void ceu_callback_register (tceu_callback* cb) {
     cb->nxt = CEU_APP.cbs;
     CEU_APP.cbs = cb;
 }
 
+#ifdef CEU_FEATURES_CALLBACK_TABLE
+/*
+ * `--ceu-features-callback-table`: binds "f" to a single command, without
+ * walking the chain of "cbs" (e.g., "CEU_CALLBACK_WCLOCK_DT" on every input
+ * or "CEU_CALLBACK_OUTPUT" on every emit). If "f" does not handle the
+ * command, the chain is still tried. Bindings survive "ceu_start" and are
+ * removed with "f=NULL".
+ */
+CEU_API void ceu_callback_register_cmd (int cmd, tceu_callback_f f) {
+    ceu_assert_ex(cmd>=0 && cmd<CEU_CALLBACK__MAX, "invalid callback command", CEU_TRACE_null);
+    CEU_APP.cbs_cmd[cmd] = f;
+}
+#endif
+#endif /* CEU_UNIT == 0 */
+
 static void ceu_callback (int cmd, tceu_callback_val p1, tceu_callback_val p2
 #ifdef CEU_FEATURES_TRACE
                          , tceu_trace trace
@@ -488,6 +806,18 @@ static void ceu_callback (int cmd, tceu_callback_val p1, tceu_callback_val p2
 #endif
                          )
 {
+#ifdef CEU_FEATURES_CALLBACK_TABLE
+    tceu_callback_f f = CEU_APP.cbs_cmd[cmd];
+    if (f!=NULL && f(cmd,p1,p2
+#ifdef CEU_FEATURES_TRACE
+                     ,trace
+#endif
+                    ))
+    {
+        return;
+    }
+#endif
+
     tceu_callback* cur = CEU_APP.cbs;
     while (cur) {
         int is_handled = cur->f(cmd,p1,p2
@@ -512,6 +842,17 @@ static void ceu_callback (int cmd, tceu_callback_val p1, tceu_callback_val p2
 
 /*****************************************************************************/
 
+#ifdef CEU_FEATURES_EXCEPTION
+int ceu_throw_ex (tceu_catch* catches, tceu_data_Exception* exception, usize len
+                  , tceu_nstk level, tceu_stk* nxt
+#ifdef CEU_FEATURES_TRACE
+                  , tceu_trace trace
+#endif
+                  );
+#endif
+
+#if defined(CEU_UNIT_ALL) || (CEU_UNIT == 0)
+
 #ifdef CEU_FEATURES_EXCEPTION
 int ceu_throw_ex (tceu_catch* catches, tceu_data_Exception* exception, usize len
                   , tceu_nstk level, tceu_stk* nxt
@@ -542,9 +883,11 @@ int ceu_throw_ex (tceu_catch* catches, tceu_data_Exception* exception, usize len
             cur->mem->_trails[cur->trl].evt.id = CEU_INPUT__STACKED;
             cur->mem->_trails[cur->trl].level = level + 1;
 //printf(">>> %d %d\n", cur->trl, cur->mem->_trails[cur->trl].lbl);
+            /* resumes only the "code" of the "catch" (and its nested ones):
+             * the continuations of the enclosing compositions (e.g., CLEAR,
+             * loops) are in the same "code", not only in "cur->trl" */
             tceu_evt   evt   = {CEU_INPUT__NONE, {NULL}};
-            //tceu_range range = { cur->mem, cur->trl, cur->trl };
-            tceu_range range = { &CEU_APP.root._mem, 0, CEU_TRAILS_N-1 };
+            tceu_range range = { cur->mem, 0, (tceu_ntrl)(cur->mem->trails_n-1) };
             nxt->evt      = evt;
             nxt->range    = range;
             nxt->params_n = 0;
@@ -555,11 +898,6 @@ int ceu_throw_ex (tceu_catch* catches, tceu_data_Exception* exception, usize len
     ceu_assert_ex(0, exception->message, trace);
     return 0;
 }
-#ifdef CEU_FEATURES_TRACE
-#define ceu_throw(a,b,c) ceu_throw_ex(a,b,c,_ceu_level,_ceu_nxt,CEU_TRACE(0))
-#else
-#define ceu_throw(a,b,c) ceu_throw_ex(a,b,c,_ceu_level,_ceu_nxt)
-#endif
 #endif
 
 #ifdef CEU_FEATURES_THREAD
@@ -604,13 +942,33 @@ int ceu_threads_gc (int force_join) {
 }
 #endif
 
+#endif /* CEU_UNIT == 0 */
+
 /*****************************************************************************/
 
+#ifdef CEU_FEATURES_EXCEPTION
+#ifdef CEU_FEATURES_TRACE
+#define ceu_throw(a,b,c) ceu_throw_ex(a,b,c,_ceu_level,_ceu_nxt,CEU_TRACE(0))
+#else
+#define ceu_throw(a,b,c) ceu_throw_ex(a,b,c,_ceu_level,_ceu_nxt)
+#endif
+#endif
+
 #define CEU_GOTO(lbl) {_ceu_lbl=lbl; goto _CEU_LBL_;}
 
-static int ceu_lbl (tceu_nstk _ceu_level, tceu_stk* _ceu_cur, tceu_stk* _ceu_nxt, tceu_code_mem* _ceu_mem, tceu_nlbl _ceu_lbl, tceu_ntrl* _ceu_trlK)
+#ifdef CEU_FEATURES_HITS
+#define CEU_LBL_HIT() { CEU_APP.lbl_cur=_ceu_lbl; CEU_APP.hits[_ceu_lbl]++; }
+#else
+#define CEU_LBL_HIT()
+#endif
+
+=== CEU_CODES_FUNCTIONS ===
+
+#if defined(CEU_UNIT_ALL) || (CEU_UNIT == 0)
+
+CEU_UNIT_STATIC int ceu_lbl (tceu_nstk _ceu_level, tceu_stk* _ceu_cur, tceu_stk* _ceu_nxt, tceu_code_mem* _ceu_mem, tceu_nlbl _ceu_lbl, tceu_ntrl* _ceu_trlK)
 {
-#define CEU_TRACE(n) ((tceu_trace){&_ceu_mem->trace,__FILE__,__LINE__+(n)})
+#define CEU_TRACE(n) ((tceu_trace){_ceu_mem,CEU_TRACE_SITE(CEU_TRACE_FILE,__LINE__+(n))})
 #ifdef CEU_STACK_MAX
     {
         static void* base = NULL;
@@ -641,6 +999,8 @@ printf("%ld %ld %d\n", (usize)(base-CEU_STACK_MAX), (usize)(&_ceu_level),
 
 _CEU_LBL_:
     //printf("-=-=- %d -=-=-\n", _ceu_lbl);
+    === CEU_CODES_DISPATCH ===
+    CEU_LBL_HIT();
     switch (_ceu_lbl) {
         CEU_LABEL_NONE:
             break;
@@ -656,120 +1016,151 @@ _CEU_LBL_:
 static int xxx = 0;
 #endif
 
-static void ceu_bcast_mark (tceu_nstk level, tceu_stk* cur)
-{
-    tceu_ntrl trlK = cur->range.trl0;
+static void ceu_bcast_mark (tceu_nstk level, tceu_stk* cur);
 
-    for (; trlK<=cur->range.trlF; trlK++)
-    {
-        tceu_trl* trl = &cur->range.mem->_trails[trlK];
+=== CEU_INPUTS_TABLES ===
+
+/* marks trail "trlK" and returns the last trail visited (skips paused trails) */
+static tceu_ntrl ceu_bcast_mark_trl (tceu_nstk level, tceu_stk* cur, tceu_ntrl trlK)
+{
+    tceu_trl* trl = &cur->range.mem->_trails[trlK];
 
-        //printf(">>> mark [%d/%p] evt=%d\n", trlK, trl, trl->evt.id);
+    //printf(">>> mark [%d/%p] evt=%d\n", trlK, trl, trl->evt.id);
 #ifdef CEU_TESTS
-        _ceu_tests_trails_visited_++;
+    _ceu_tests_trails_visited_++;
 #endif
-        switch (trl->evt.id)
-        {
+#ifdef CEU_FEATURES_STATS
+    CEU_APP.stats.trails++;
+#endif
+    switch (trl->evt.id)
+    {
 #ifdef CEU_FEATURES_POOL
-            case CEU_INPUT__PROPAGATE_POOL: {
-                tceu_code_mem_dyn* v = trl->evt.pak->first.nxt;
-                while (v != &trl->evt.pak->first) {
-                    tceu_range range_ = { &v->mem[0],
-                                          0, (tceu_ntrl)((&v->mem[0])->trails_n-1) };
-                    tceu_stk cur_ = *cur;
-                    cur_.range = range_;
-                    ceu_bcast_mark(level, &cur_);
-                    v = v->nxt;
-                }
-                break;
+        case CEU_INPUT__PROPAGATE_POOL: {
+            if (cur->evt.id==CEU_INPUT__CLEAR && trl->evt.pak->no_fins) {
+                break;  /* nothing to awake (see "ceu_code_mem_dyn_release") */
             }
+            tceu_code_mem_dyn* v = trl->evt.pak->first.nxt;
+            while (v != &trl->evt.pak->first) {
+                tceu_range range_ = { &v->mem[0],
+                                      0, (tceu_ntrl)((&v->mem[0])->trails_n-1) };
+                tceu_stk cur_ = *cur;
+                cur_.range = range_;
+                ceu_bcast_mark(level, &cur_);
+                v = v->nxt;
+            }
+            break;
+        }
 #endif
 
 #ifdef CEU_FEATURES_PAUSE
-            case CEU_INPUT__PAUSE_BLOCK: {
-                u8 was_paused = trl->pse_paused;
-                if ( (cur->evt.id == trl->pse_evt.id)                               &&
-                     (cur->evt.id<CEU_EVENT__MIN || cur->evt.mem==trl->pse_evt.mem) &&
-                     (*((u8*)cur->params) != trl->pse_paused) )
-                {
-                    trl->pse_paused = *((u8*)cur->params);
-
-                    tceu_evt evt_;
-                    tceu_range range_ = { cur->range.mem,
-                                          (tceu_ntrl)(trlK+1), (tceu_ntrl)(trlK+trl->pse_skip) };
-                    if (trl->pse_paused) {
-                        evt_.id = CEU_INPUT__PAUSE;
-                    } else {
-                        CEU_APP.wclk_min_set = 0;   /* maybe resuming a timer, let it be the minimum set */
-                        evt_.id = CEU_INPUT__RESUME;
-                    }
-                    tceu_stk cur_ = { evt_, range_, NULL, 0 };
-                    ceu_bcast_mark(level, &cur_);
-                }
-                /* don't skip if pausing now */
-                if (was_paused && cur->evt.id!=CEU_INPUT__CLEAR) {
-                                  /* also don't skip on CLEAR (going reverse) */
-                    trlK += trl->pse_skip;
+        case CEU_INPUT__PAUSE_BLOCK: {
+            u8 was_paused = trl->pse_paused;
+            if ( (cur->evt.id == trl->pse_evt.id)                               &&
+                 (cur->evt.id<CEU_EVENT__MIN || cur->evt.mem==trl->pse_evt.mem) &&
+                 (*((u8*)cur->params) != trl->pse_paused) )
+            {
+                trl->pse_paused = *((u8*)cur->params);
+
+                tceu_evt evt_;
+                tceu_range range_ = { cur->range.mem,
+                                      (tceu_ntrl)(trlK+1), (tceu_ntrl)(trlK+trl->pse_skip) };
+                if (trl->pse_paused) {
+                    evt_.id = CEU_INPUT__PAUSE;
+                } else {
+                    CEU_APP.wclk_min_set = 0;   /* maybe resuming a timer, let it be the minimum set */
+                    evt_.id = CEU_INPUT__RESUME;
                 }
-                break;
+                tceu_stk cur_ = { evt_, range_, NULL, 0 };
+                ceu_bcast_mark(level, &cur_);
             }
+            /* don't skip if pausing now */
+            if (was_paused && cur->evt.id!=CEU_INPUT__CLEAR) {
+                              /* also don't skip on CLEAR (going reverse) */
+                trlK += trl->pse_skip;
+            }
+            break;
+        }
 #endif
 
-            case CEU_INPUT__PROPAGATE_CODE: {
+        case CEU_INPUT__PROPAGATE_CODE: {
 #if 0
-                // TODO: simple optimization that could be done
-                //          - do it also for POOL?
-                if (occ->evt.id==CEU_INPUT__CODE_TERMINATED && occ->params==trl->evt.mem ) {
-                    // dont propagate when I am terminating
-                } else
+            // TODO: simple optimization that could be done
+            //          - do it also for POOL?
+            if (occ->evt.id==CEU_INPUT__CODE_TERMINATED && occ->params==trl->evt.mem ) {
+                // dont propagate when I am terminating
+            } else
 #endif
-                tceu_range range_ = {
-                    (tceu_code_mem*)trl->evt.mem,
-                    0,
-                    (tceu_ntrl)(((tceu_code_mem*)trl->evt.mem)->trails_n-1)
-                };
-                tceu_stk cur_ = *cur;
-                cur_.range = range_;
-                ceu_bcast_mark(level, &cur_);
-                //break;    (may awake from CODE_TERMINATED)
-            }
+            tceu_range range_ = {
+                (tceu_code_mem*)trl->evt.mem,
+                0,
+                (tceu_ntrl)(((tceu_code_mem*)trl->evt.mem)->trails_n-1)
+            };
+            tceu_stk cur_ = *cur;
+            cur_.range = range_;
+            ceu_bcast_mark(level, &cur_);
+            //break;    (may awake from CODE_TERMINATED)
+        }
 
-            default: {
-                if (cur->evt.id == CEU_INPUT__CLEAR) {
-                    if (trl->evt.id == CEU_INPUT__FINALIZE) {
+        default: {
+            if (cur->evt.id == CEU_INPUT__CLEAR) {
+                if (trl->evt.id == CEU_INPUT__FINALIZE) {
 //printf("AWK %d %d\n", trlK, trl->lbl);
-                        goto _CEU_AWAKE_YES_;
-                    }
-                } else if (cur->evt.id==CEU_INPUT__CODE_TERMINATED && trl->evt.id==CEU_INPUT__PROPAGATE_CODE) {
+                    goto _CEU_AWAKE_YES_;
+                }
+            } else if (cur->evt.id==CEU_INPUT__CODE_TERMINATED && trl->evt.id==CEU_INPUT__PROPAGATE_CODE) {
 //printf("TERM %d %d\n", trlK, trl->lbl);
-                    if (trl->evt.mem == cur->evt.mem) {
-                        goto _CEU_AWAKE_YES_;
-                    }
-                } else if (trl->evt.id == cur->evt.id) {
+                if (trl->evt.mem == cur->evt.mem) {
+                    goto _CEU_AWAKE_YES_;
+                }
+            } else if (trl->evt.id == cur->evt.id) {
 #ifdef CEU_FEATURES_PAUSE
-                    if (cur->evt.id==CEU_INPUT__PAUSE || cur->evt.id==CEU_INPUT__RESUME) {
-                        goto _CEU_AWAKE_YES_;
-                    }
+                if (cur->evt.id==CEU_INPUT__PAUSE || cur->evt.id==CEU_INPUT__RESUME) {
+                    goto _CEU_AWAKE_YES_;
+                }
 #endif
-                    if (trl->evt.id>CEU_EVENT__MIN || trl->evt.id==CEU_INPUT__CODE_TERMINATED) {
-                        if (trl->evt.mem == cur->evt.mem) {
-                            goto _CEU_AWAKE_YES_;   /* internal event matches "mem" */
-                        }
-                    } else {
-                        if (cur->evt.id != CEU_INPUT__NONE) {
-                            goto _CEU_AWAKE_YES_;       /* external event matches */
-                        }
+                if (trl->evt.id>CEU_EVENT__MIN || trl->evt.id==CEU_INPUT__CODE_TERMINATED) {
+                    if (trl->evt.mem == cur->evt.mem) {
+                        goto _CEU_AWAKE_YES_;   /* internal event matches "mem" */
+                    }
+                } else {
+                    if (cur->evt.id != CEU_INPUT__NONE) {
+                        goto _CEU_AWAKE_YES_;       /* external event matches */
                     }
                 }
+            }
 
-                continue;
+            break;
 
 _CEU_AWAKE_YES_:
-                trl->evt.id = CEU_INPUT__STACKED;
-                trl->level  = level;
-            }
+            trl->evt.id = CEU_INPUT__STACKED;
+            trl->level  = level;
         }
     }
+    return trlK;
+}
+
+static void ceu_bcast_mark (tceu_nstk level, tceu_stk* cur)
+{
+#ifdef CEU_INPUT_TABLES
+    /* external inputs on a whole "code": only the trails that may await them */
+    tceu_code_mem* mem = cur->range.mem;
+    if (mem->inputs!=0 && cur->evt.id>=CEU_INPUT__ASYNC && cur->evt.id<CEU_EVENT__MIN &&
+        cur->range.trl0==0 && cur->range.trlF==mem->trails_n-1)
+    {
+        const tceu_inputs_idx* idx = CEU_INPUTS_IDX[mem->inputs-1];
+        tceu_inputs_idx i = idx[cur->evt.id - CEU_INPUT__ASYNC];
+        tceu_inputs_idx n = idx[cur->evt.id - CEU_INPUT__ASYNC + 1];
+        for (; i<n; i++) {
+            ceu_bcast_mark_trl(level, cur, CEU_INPUTS_TRAILS[i]);
+        }
+        return;
+    }
+#endif
+
+    tceu_ntrl trlK = cur->range.trl0;
+    for (; trlK<=cur->range.trlF; trlK++) {
+        trlK = ceu_bcast_mark_trl(level, cur, trlK);
+    }
 }
 
 static int ceu_bcast_exec (tceu_nstk level, tceu_stk* cur, tceu_stk* nxt)
@@ -821,6 +1212,10 @@ static int ceu_bcast_exec (tceu_nstk level, tceu_stk* cur, tceu_stk* nxt)
 
 #ifdef CEU_FEATURES_POOL
             case CEU_INPUT__PROPAGATE_POOL: {
+                if (cur->evt.id==CEU_INPUT__CLEAR && trl->evt.pak->no_fins) {
+                    ceu_code_mem_dyn_release(trl->evt.pak);
+                    break;
+                }
                 ceu_assert_ex(trl->evt.pak->n_traversing < 255, "bug found", CEU_TRACE_null);
                 trl->evt.pak->n_traversing++;
                 tceu_code_mem_dyn* v = trl->evt.pak->first.nxt;
@@ -847,7 +1242,11 @@ static int ceu_bcast_exec (tceu_nstk level, tceu_stk* cur, tceu_stk* nxt)
                 if (trl->evt.id==CEU_INPUT__STACKED && trl->level==level) {
                     trl->evt.id = CEU_INPUT__NONE;
 //printf("STK = %d\n", trlK);
-                    if (ceu_lbl(level, cur, nxt, cur->range.mem, trl->lbl, &trlK)) {
+                    int ret = ceu_lbl(level, cur, nxt, cur->range.mem, trl->lbl, &trlK);
+#ifdef CEU_FEATURES_HITS
+                    CEU_APP.lbl_cur = CEU_LABEL_NONE;
+#endif
+                    if (ret) {
                         return 1;
                     }
 //printf("<<< trlK = %d\n", trlK);
@@ -885,6 +1284,9 @@ void ceu_bcast (tceu_nstk level, tceu_stk* cur)
                 break;
             case CEU_INPUT__ASYNC:
                 CEU_APP.async_pending = 0;
+#ifdef CEU_ASYNC_BUDGET
+                CEU_APP.async_budget  = CEU_ASYNC_BUDGET;   /* new time slice */
+#endif
                 break;
         }
         if (cur->evt.id != CEU_INPUT__WCLOCK) {
@@ -892,6 +1294,17 @@ void ceu_bcast (tceu_nstk level, tceu_stk* cur)
         }
     }
 
+#ifdef CEU_FEATURES_STATS
+    if (level > CEU_APP.stats.level_max) {
+        CEU_APP.stats.level_max = level;
+    }
+#endif
+
+    /* innermost frame over "range.mem" until it returns (or dies) */
+    tceu_code_mem* mem = cur->range.mem;
+    cur->mem_prv = mem->stk;
+    mem->stk = cur;
+
     //printf(">>> BCAST[%d]: %d\n", cur->evt.id, level);
     ceu_bcast_mark(level, cur);
     while (1) {
@@ -910,32 +1323,163 @@ void ceu_bcast (tceu_nstk level, tceu_stk* cur)
         }
     }
 
+    if (cur->is_alive) {
+        mem->stk = cur->mem_prv;    /* otherwise, "mem" may be gone */
+    }
+
     CEU_APP.stack_i -= cur->params_n;
     //printf("<<< BCAST: %d\n", level);
 }
 
+#ifdef CEU_FEATURES_STATS
+static usize ceu_stats_clock (void) {
+    ceu_callback_ret.size = 0;
+    ceu_callback_void_void(CEU_CALLBACK_CLOCK, CEU_TRACE_null);
+    return ceu_callback_ret.size;
+}
+
+CEU_API void ceu_stats (tceu_stats* stats) {
+    CEU_APP.stats.vector_reallocs = ceu_vector_reallocs;
+    *stats = CEU_APP.stats;
+}
+#endif
+
+#ifdef CEU_FEATURES_RECORD
+static const usize CEU_INPUTS_SIZES[CEU_EVENT__MIN] = {   /* others: 0 */
+#ifdef CEU_FEATURES_THREAD
+    [CEU_INPUT__THREAD] = sizeof(CEU_THREADS_T),
+#endif
+    [CEU_INPUT__WCLOCK] = sizeof(s32),
+    === CEU_EXTS_SIZES_INPUT ===
+};
+#endif
+
 CEU_API void ceu_input (tceu_nevt id, void* params)
 {
+#ifdef CEU_FEATURES_STATS
+    usize t0 = ceu_stats_clock();
+#endif
     ceu_callback_void_void(CEU_CALLBACK_WCLOCK_DT, CEU_TRACE_null);
     s32 dt = ceu_callback_ret.num;
+#ifdef CEU_FEATURES_RECORD
+    {
+        tceu_record rec = { dt, id, CEU_INPUTS_SIZES[id], params };
+        ceu_callback_num_ptr(CEU_CALLBACK_RECORD, 0, &rec, CEU_TRACE_null);
+    }
+#endif
     if (dt != CEU_WCLOCK_INACTIVE) {
         tceu_evt   evt   = {CEU_INPUT__WCLOCK, {NULL}};
         tceu_range range = {(tceu_code_mem*)&CEU_APP.root, 0, CEU_TRAILS_N-1};
-        tceu_stk   cur   = { evt, range, &dt, 0, 1, NULL };
+        tceu_stk   cur   = { evt, range, &dt, 0, 1, NULL, NULL };
+#ifdef CEU_FEATURES_STATS
+        CEU_APP.stats.reactions[CEU_INPUT__WCLOCK]++;
+#endif
         ceu_bcast(1, &cur);
     }
     if (id != CEU_INPUT__NONE) {
         tceu_evt   evt   = {id, {NULL}};
         tceu_range range = {(tceu_code_mem*)&CEU_APP.root, 0, CEU_TRAILS_N-1};
-        tceu_stk   cur   = { evt, range, params, 0, 1, NULL };
+        tceu_stk   cur   = { evt, range, params, 0, 1, NULL, NULL };
+#ifdef CEU_FEATURES_STATS
+        CEU_APP.stats.reactions[id]++;
+#endif
         ceu_bcast(1, &cur);
     }
+#ifdef CEU_FEATURES_OUTPUT_BATCH
+    ceu_output_flush();
+#endif
+#ifdef CEU_FEATURES_STATS
+    {
+        usize dt = ceu_stats_clock() - t0;
+        u8    i  = 0;
+        for (; dt!=0 && i<CEU_STATS_LATENCY_N-1; dt>>=1) {
+            i++;
+        }
+        CEU_APP.stats.latency[i]++;
+    }
+#endif
+}
+
+#ifdef CEU_FEATURES_SNAPSHOT
+#define CEU_SNAPSHOT_HASH === CEU_SNAPSHOT_HASH ===
+
+CEU_API void ceu_snapshot_save (tceu_snapshot* snap) {
+    ceu_assert_ex(CEU_APP.stack_i == 0, "invalid snapshot : inside reaction", CEU_TRACE_null);
+    snap->hash  = CEU_SNAPSHOT_HASH;
+    snap->size  = sizeof(tceu_app);
+    snap->text  = (usize)&CEU_APP - (usize)&ceu_start;
+    snap->app   = (usize)&CEU_APP;
+    snap->image = &CEU_APP;
+}
+
+/* 0 if "snap" is from another program, options, binary, or addresses */
+CEU_API int ceu_snapshot_restore (tceu_snapshot* snap) {
+    if (snap->hash != CEU_SNAPSHOT_HASH ||
+        snap->size != sizeof(tceu_app)  ||
+        snap->text != (usize)&CEU_APP - (usize)&ceu_start ||
+        snap->app  != (usize)&CEU_APP)
+    {
+        return 0;
+    }
+
+    /* kept from this run */
+    int             argc = CEU_APP.argc;
+    char**          argv = CEU_APP.argv;
+    tceu_callback*  cbs  = CEU_APP.cbs_env;
+#ifdef CEU_FEATURES_CALLBACK_TABLE
+    tceu_callback_f cmds[CEU_CALLBACK__MAX];
+    memcpy(cmds, CEU_APP.cbs_cmd, sizeof(cmds));
+#endif
+
+    memcpy(&CEU_APP, snap->image, sizeof(tceu_app));
+
+    CEU_APP.argc = argc;
+    CEU_APP.argv = argv;
+
+    /* the chain registered by the program ends in the old "cb" */
+    {
+        tceu_callback** nxt = &CEU_APP.cbs;
+        while (*nxt!=NULL && *nxt!=CEU_APP.cbs_env) {
+            nxt = &(*nxt)->nxt;
+        }
+        *nxt = cbs;
+        CEU_APP.cbs_env = cbs;
+    }
+#ifdef CEU_FEATURES_CALLBACK_TABLE
+    {
+        int i;
+        for (i=0; i<CEU_CALLBACK__MAX; i++) {
+            if (cmds[i] != NULL) {
+                CEU_APP.cbs_cmd[i] = cmds[i];
+            }
+        }
+    }
+#endif
+    return 1;
 }
+#endif
 
 CEU_API void ceu_start (tceu_callback* cb, int argc, char* argv[]) {
     CEU_APP.argc     = argc;
     CEU_APP.argv     = argv;
 
+#ifdef CEU_FEATURES_SNAPSHOT
+    CEU_APP.cbs     = cb;
+    CEU_APP.cbs_env = cb;
+    ceu_callback_ret.ptr = NULL;    /* unless handled */
+    ceu_callback_void_void(CEU_CALLBACK_SNAPSHOT, CEU_TRACE_null);
+    if (ceu_callback_ret.ptr != NULL) {
+        if (ceu_snapshot_restore((tceu_snapshot*)ceu_callback_ret.ptr)) {
+            ceu_callback_void_void(CEU_CALLBACK_START, CEU_TRACE_null);
+            /* the environment (re)starts its clock on "START": the pending
+             * timers count from now */
+            ceu_callback_num_ptr(CEU_CALLBACK_WCLOCK_MIN, CEU_APP.wclk_min_set, NULL, CEU_TRACE_null);
+            return;
+        }
+        ceu_log("snapshot rejected : incompatible program or addresses\n");
+    }
+#endif
+
     CEU_APP.end_ok   = 0;
 
     CEU_APP.seq      = 0;
@@ -944,6 +1488,9 @@ CEU_API void ceu_start (tceu_callback* cb, int argc, char* argv[]) {
     CEU_APP.cbs = cb;
 
     CEU_APP.async_pending = 0;
+#ifdef CEU_ASYNC_BUDGET
+    CEU_APP.async_budget  = CEU_ASYNC_BUDGET;
+#endif
 
     CEU_APP.wclk_late = 0;
     CEU_APP.wclk_min_set = CEU_WCLOCK_INACTIVE;
@@ -951,9 +1498,10 @@ CEU_API void ceu_start (tceu_callback* cb, int argc, char* argv[]) {
 
     CEU_APP.root._mem.up_mem   = NULL;
     CEU_APP.root._mem.depth    = 0;
+    CEU_APP.root._mem.stk      = NULL;
 
 #ifdef CEU_FEATURES_TRACE
-    CEU_APP.root._mem.trace.up = NULL;
+    CEU_APP.root._mem.trace    = 0;
 #endif
 #ifdef CEU_FEATURES_EXCEPTION
     CEU_APP.root._mem.catches  = NULL;
@@ -976,7 +1524,23 @@ CEU_API void ceu_start (tceu_callback* cb, int argc, char* argv[]) {
 
     CEU_APP.stack_i = 0;
 
+#ifdef CEU_FEATURES_STATS
+    memset(&CEU_APP.stats, 0, sizeof(CEU_APP.stats));
+    ceu_vector_reallocs = 0;
+#endif
+#ifdef CEU_FEATURES_HITS
+    CEU_APP.lbl_cur = CEU_LABEL_NONE;
+    memset(CEU_APP.hits, 0, sizeof(CEU_APP.hits));
+#endif
+#ifdef CEU_FEATURES_OUTPUT_BATCH
+    CEU_APP.outputs.n   = 0;
+    CEU_APP.outputs.len = 0;
+#endif
+
     CEU_APP.root._mem.trails_n = CEU_TRAILS_N;
+#ifdef CEU_INPUT_TABLES
+    CEU_APP.root._mem.inputs   = CEU_INPUTS_ROOT;
+#endif
     memset(&CEU_APP.root._trails, 0, CEU_TRAILS_N*sizeof(tceu_trl));
     CEU_APP.root._trails[0].evt.id = CEU_INPUT__STACKED;
     CEU_APP.root._trails[0].level  = 1;
@@ -986,8 +1550,14 @@ CEU_API void ceu_start (tceu_callback* cb, int argc, char* argv[]) {
 
     tceu_evt   evt   = {CEU_INPUT__NONE, {NULL}};
     tceu_range range = {(tceu_code_mem*)&CEU_APP.root, 0, CEU_TRAILS_N-1};
-    tceu_stk   cur   = { evt, range, NULL, 0, 1, NULL };
+    tceu_stk   cur   = { evt, range, NULL, 0, 1, NULL, NULL };
+#ifdef CEU_FEATURES_STATS
+    CEU_APP.stats.reactions[CEU_INPUT__NONE]++;
+#endif
     ceu_bcast(1, &cur);
+#ifdef CEU_FEATURES_OUTPUT_BATCH
+    ceu_output_flush();
+#endif
 }
 CEU_API void ceu_stop (void) {
 #ifdef CEU_FEATURES_THREAD
@@ -1001,6 +1571,14 @@ CEU_API void ceu_stop (void) {
 
 CEU_API int ceu_loop (tceu_callback* cb, int argc, char* argv[])
 {
+#ifdef CEU_SIZES
+    /* `-DCEU_SIZES`: report the size of each `data` and `code` instance */
+#define CEU_SIZE(tp) printf("sizeof(%s) = %d\n", #tp, (int)sizeof(tp))
+    === CEU_SIZES ===
+    CEU_SIZE(tceu_app);
+#undef CEU_SIZE
+#endif
+
     ceu_start(cb, argc, argv);
 
     while (!CEU_APP.end_ok) {
@@ -1026,3 +1604,5 @@ CEU_API int ceu_loop (tceu_callback* cb, int argc, char* argv[])
 
     return CEU_APP.end_val;
 }
+
+#endif /* CEU_UNIT == 0 */
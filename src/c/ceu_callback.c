@@ -2,13 +2,44 @@
 
 === CEU_FEATURES ===        /* CEU_FEATURES */
 
+/*
+ * Separate compilation units (`ceu --ceu-units=N`):
+ *  - CEU_UNIT undefined: everything in a single unit (default)
+ *  - CEU_UNIT == 0:      runtime, main program, and shared globals
+ *  - CEU_UNIT == K:      `code` abstractions assigned to unit K
+ * Each unit is the same file compiled with `-DCEU_UNIT=K`.
+ */
+#ifndef CEU_UNIT
+#define CEU_UNIT_ALL
+#define CEU_UNIT_STATIC static
+#define CEU_UNIT_GLOBAL static
+#else
+#define CEU_UNIT_STATIC
+#if CEU_UNIT == 0
+#define CEU_UNIT_GLOBAL
+#else
+#define CEU_UNIT_GLOBAL extern
+#endif
+#endif
+
 #ifdef CEU_FEATURES_TRACE
-#define CEU_TRACE_null   ((tceu_trace){NULL,NULL,0})
+/*
+ * Trace sites are 32 bits: an index in "CEU_TRACE_FILES" (generated) and a
+ * line, which saturates at "CEU_TRACE_LINE_MAX" (reported as "?").
+ * The chain of sites that invoked the enclosing `code` abstractions
+ * is only reconstructed from "mem" when an error is reported (see "ceu_trace").
+ */
+#define CEU_TRACE_LINE_BITS 20
+#define CEU_TRACE_LINE_MAX  ((1<<CEU_TRACE_LINE_BITS)-1)
+#define CEU_TRACE_SITE(file,line) ((((u32)(file))<<CEU_TRACE_LINE_BITS) |   \
+                                   (((u32)(line) < CEU_TRACE_LINE_MAX) ?    \
+                                        (u32)(line) : CEU_TRACE_LINE_MAX))
+#define CEU_TRACE_null   ((tceu_trace){NULL,0})
+#define CEU_TRACE_FILE   0  /* redefined before each "#line" */
 
 typedef struct tceu_trace {
-    struct tceu_trace* up;
-    const char* file;
-    u32 line;
+    struct tceu_code_mem* mem;
+    u32 site;
 } tceu_trace;
 #endif
 
@@ -18,7 +49,7 @@ typedef union tceu_callback_val {
     usize size;
 } tceu_callback_val;
 
-static tceu_callback_val ceu_callback_ret;
+CEU_UNIT_GLOBAL tceu_callback_val ceu_callback_ret;
 
 typedef int (*tceu_callback_f) (int, tceu_callback_val, tceu_callback_val
 #ifdef CEU_FEATURES_TRACE
@@ -151,37 +182,15 @@ enum {
     CEU_CALLBACK_WCLOCK_DT,
     CEU_CALLBACK_OUTPUT,
     CEU_CALLBACK_REALLOC,
+    CEU_CALLBACK_CLOCK,         /* current time in "ceu_callback_ret.size" (see "tceu_stats") */
+    CEU_CALLBACK_RECORD,        /* every "ceu_input" (see "tceu_record") */
+    CEU_CALLBACK_OUTPUT_BATCH,  /* end of reaction (see "tceu_output_batch") */
+    CEU_CALLBACK_SNAPSHOT,      /* snapshot to restore in "ceu_start" (see "tceu_snapshot") */
+    CEU_CALLBACK__MAX
 };
 
 #ifdef CEU_FEATURES_TRACE
-static void ceu_trace (tceu_trace trace, const char* msg) {
-    static bool IS_FIRST = 1;
-    bool is_first = IS_FIRST;
-
-    IS_FIRST = 0;
-
-    if (trace.up != NULL) {
-        ceu_trace(*trace.up, msg);
-    }
-
-    if (is_first) {
-        IS_FIRST = 1;
-        ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"\n", CEU_TRACE_null);
-    }
-
-    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"[",          CEU_TRACE_null);
-    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)(trace.file), CEU_TRACE_null);
-    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)":",          CEU_TRACE_null);
-    ceu_callback_num_num(CEU_CALLBACK_LOG, 2, trace.line,          CEU_TRACE_null);
-    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"]",          CEU_TRACE_null);
-    ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)" -> ",       CEU_TRACE_null);
-
-    if (is_first) {
-        ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"runtime error: ", CEU_TRACE_null);
-        ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)(msg),             CEU_TRACE_null);
-        ceu_callback_num_ptr(CEU_CALLBACK_LOG, 0, (void*)"\n",              CEU_TRACE_null);
-    }
-}
+static void ceu_trace (tceu_trace trace, const char* msg);  /* see "ceu.c" */
 #else
 #define ceu_trace(a,b)
 #endif
@@ -9,6 +9,12 @@ typedef struct {
     byte**  queue; /* NULL on dynamic pools */
 } tceu_pool;
 
+void  ceu_pool_init  (tceu_pool* pool, usize len, usize unit, byte** queue, byte* buf);
+byte* ceu_pool_alloc (tceu_pool* pool);
+void  ceu_pool_free  (tceu_pool* pool, byte* val);
+
+#if defined(CEU_UNIT_ALL) || (CEU_UNIT == 0)
+
 void ceu_pool_init (tceu_pool* pool, usize len, usize unit, byte** queue, byte* buf)
 {
     usize i;
@@ -47,3 +53,5 @@ void ceu_pool_free (tceu_pool* pool, byte* val) {
     pool->queue[empty] = val;
     pool->free++;
 }
+
+#endif /* CEU_UNIT == 0 */
@@ -89,6 +89,12 @@ void  ceu_vector_copy_ex         (tceu_vector* dst, usize dst_i, tceu_vector* sr
 char* ceu_vector_tochar (tceu_vector* vector);
 #endif
 
+#ifdef CEU_FEATURES_STATS
+CEU_UNIT_GLOBAL u32 ceu_vector_reallocs;    /* see "tceu_stats" */
+#endif
+
+#if defined(CEU_UNIT_ALL) || (CEU_UNIT == 0)
+
 void ceu_vector_init (tceu_vector* vector, usize max, bool is_ring,
                       bool is_dyn, usize unit, byte* buf) {
     vector->len        = 0;
@@ -122,6 +128,9 @@ byte* ceu_vector_setmax_ex_      (tceu_vector* vector, usize len, bool freeze
         }
     } else {
         ceu_assert_ex(len > vector->max, "not implemented: shrinking vectors", trace);
+#ifdef CEU_FEATURES_STATS
+        ceu_vector_reallocs++;
+#endif
         ceu_callback_ptr_size(CEU_CALLBACK_REALLOC,
                               vector->buf,
                               len*vector->unit,
@@ -311,3 +320,5 @@ void  ceu_vector_copy_ex         (tceu_vector* dst, usize dst_i, tceu_vector* sr
 
     memcpy(ceu_vector_buf_get(dst,dst_i), ceu_vector_buf_get(src,src_i), n);
 }
+
+#endif /* CEU_UNIT == 0 */
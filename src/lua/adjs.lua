@@ -766,12 +766,19 @@ error'TODO: luacov never executes this?'
             end
         end
 
+        -- pool[n->max]: `max` goes last (see `Pool`)
+        local max
+        if tag == 'Pool' then
+            max = me[3]
+            AST.remove(me, 3)
+        end
+
         if tag=='Var' or tag=='Pool' or tag=='Vec' then
             is_alias, dim_or_mods, tp, id, set = unpack(me)
             AST.set(me, 2, tp)
             AST.set(me, 3, id)
             AST.set(me, 4, dim_or_mods)
-            AST.set(me, 5, nil)
+            AST.set(me, 5, max)
         else
             is_alias, tp, id, set = unpack(me)
             AST.set(me, 4, nil)
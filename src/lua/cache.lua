@@ -0,0 +1,148 @@
+-- Front-end cache (`--ceu-cache=DIR`):
+--  - the key hashes the input, the `ceu-*` options, and the compiler itself
+--    (version, Lua sources, and C runtime)
+--  - hit:  writes the cached C to `--ceu-output` and replays the warnings,
+--          skipping all passes
+--  - miss: runs all passes and stores their output in `DIR/<key>.ceu.c`
+-- Entries are written to a temporary file and then renamed, so that parallel
+-- builds sharing the same `DIR` never see partial entries.
+-- (The passes analyse the program as a whole (declarations, trails, labels,
+-- memory layout), so there is no finer granularity, such as each `#include`,
+-- to reuse across builds.)
+
+CACHE = {
+    key  = nil,
+    wrns = {},
+}
+
+-- FNV-1a (64 bits, wraps around Lua integers)
+function CACHE.hash (str, h)
+    h = h or 0xCBF29CE484222325
+    for i=1, #str, 4096 do
+        local t = { string.byte(str, i, i+4095) }
+        for j=1, #t do
+            h = (h ~ t[j]) * 0x100000001B3
+        end
+    end
+    return h
+end
+
+local function PATH (ext)
+    return CEU.opts.ceu_cache..'/'..CACHE.key..'.ceu'..ext
+end
+
+-- the running compiler: the packed `ceu` holds all Lua sources and the C
+-- runtime, while the unpacked `ceu.lua` loads the sources next to it
+local function SELF (h)
+    local exe = arg and arg[0]
+    if not exe then
+        return h
+    end
+    local files = { exe }
+    if string.match(exe, 'ceu%.lua$') then
+        local dir = string.match(exe, '^(.*/)') or ''
+        local f = assert(io.popen('ls "'..dir..'"*.lua 2>/dev/null'))
+        files = {}
+        for file in f:lines() do
+            files[#files+1] = file
+        end
+        f:close()
+    end
+    for _, file in ipairs(files) do
+        local f = ASR(io.open(file))
+        h = CACHE.hash(f:read'*a', h)
+        f:close()
+    end
+    return h
+end
+
+local function OUTPUT (c)
+    if CEU.opts.ceu_output == '-' then
+        print(c)
+    else
+        local C = ASR(io.open(CEU.opts.ceu_output,'w'))
+        C:write(c)
+        C:close()
+    end
+end
+
+function CACHE.get ()
+    -- the label map (`--ceu-label-map`) requires all passes
+    if (not CEU.opts.ceu_cache) or CEU.opts.ceu_label_map then
+        return false
+    end
+
+    local f = ASR(io.open(CEU.opts.ceu_input))
+    local src = f:read'*a'
+    f:close()
+
+    -- the name of the source appears in the output (see `lines.lua`), but
+    -- not the name of the preprocessed file (which may be temporary)
+    local opts = { 'file='..(CEU.opts.pre_input or CEU.opts.ceu_input) }
+    for k, v in pairs(CEU.opts) do
+        if string.sub(k,1,4)=='ceu_' and k~='ceu_input' and k~='ceu_output'
+            and k~='ceu_cache' and k~='ceu_profile'
+        then
+            opts[#opts+1] = k..'='..tostring(v)
+        end
+    end
+    table.sort(opts)
+
+    local h = CACHE.hash(PAK.ceu_ver..' '..PAK.ceu_git)
+    h = CACHE.hash(PAK.files.ceu_c, h)
+    h = SELF(h)
+    h = CACHE.hash(table.concat(opts,'\n'), h)
+    h = CACHE.hash(src, h)
+    CACHE.key = string.format('%016X', h)
+
+    -- entry: <#wrns>\n<wrns><c>
+    local f = io.open(PATH'.c')
+    if f then
+        local n = tonumber(f:read'*l')
+        local wrns = n and f:read(n)
+        local c = f:read'*a'
+        f:close()
+        if n and #wrns==n then
+            if wrns ~= '' then
+                io.stderr:write(wrns)
+            end
+            OUTPUT(c)
+            return true
+        end
+    end
+
+    -- miss: record warnings to replay them on hits
+    local dbg = DBG2
+    DBG2 = function (...)
+        local t = {}
+        for i=1, select('#',...) do
+            t[#t+1] = tostring( select(i,...) )
+        end
+        CACHE.wrns[#CACHE.wrns+1] = table.concat(t,'\t')..'\n'
+        return dbg(...)
+    end
+    return false
+end
+
+function CACHE.put (c)
+    if not CACHE.key then
+        return
+    end
+    os.execute('mkdir -p "'..CEU.opts.ceu_cache..'"')
+
+    -- unique suffix for the temporary file in the same directory (rename)
+    local tmp = os.tmpname()
+    os.remove(tmp)
+    tmp = PATH('.c.'..string.match(tmp,'[^/]*$'))
+
+    local wrns = table.concat(CACHE.wrns)
+    local f = io.open(tmp, 'w')
+    if not f then
+        return  -- cache is best effort
+    end
+    f:write(#wrns..'\n'..wrns..c)
+    f:close()
+    if not os.rename(tmp, PATH'.c') then
+        os.remove(tmp)
+    end
+end
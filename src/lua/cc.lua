@@ -1,9 +1,140 @@
+local f = ASR(io.open(CEU.opts.cc_input))
+local src = f:read'*a'
+f:close()
+
+-------------------------------------------------------------------------------
+-- `--ceu-units=N`
+--  - compiles `-DCEU_UNIT=0..N` separately (`--cc-jobs` at a time)
+--  - skips units with the same contents (hash) of the previous compilation
+--  - links all units together
+--  - the hash covers what the compilation of each unit depends on:
+--      - the unit after the C preprocessor, so that the blocks of the other
+--        units, and `#line` markers (unless `-g`) do not count, but natives
+--        and `__LINE__` (e.g., `--ceu-features-trace`) do
+--      - the values of the labels it refers to, but not the label enum (with
+--        the names and values of all labels)
+--    So an edit in a `code` also rebuilds the units of the codes after it
+--    only if it adds or removes labels or changes their memory layout.
+
+local function UNITS (units)
+    -- values of all labels
+    local labels = { CEU_LABEL_NONE=0 }
+    do
+        local enum = string.match(src, '\nenum {\n    CEU_LABEL_NONE = 0,\n(.-)\n};\n')
+        ASR(enum, 'bug found')
+        local n = 0
+        for id in string.gmatch(enum, '(CEU_LABEL_[%w_]+)') do
+            n = n + 1
+            labels[id] = n
+        end
+    end
+
+    local common = CACHE.hash(CEU.opts.cc_exe..' '..CEU.opts.cc_args)
+    local is_g = string.find(' '..CEU.opts.cc_args, '%s%-g')
+
+    local function HASH (k)
+        local cc = CEU.opts.cc_exe..' -xc -E '..(is_g and '' or '-P ')..
+                    '-DCEU_UNIT='..k..' "'..CEU.opts.cc_input..'" '..
+                    CEU.opts.cc_args..' 2>/dev/null'
+        local f = assert(io.popen(cc))
+        local pre = f:read'*a'
+        if not f:close() then
+            return nil      -- the compilation reports the error
+        end
+        pre = string.gsub(pre, 'enum {%s*CEU_LABEL_NONE = 0,.-};', '', 1)
+        pre = string.gsub(pre, 'CEU_LABEL_[%w_]+', labels)
+        if not is_g then
+            -- fields of unions of memories are named after AST nodes
+            local mems = {}
+            local n = 0
+            pre = string.gsub(pre, '__mem_%d+', function (id)
+                if not mems[id] then
+                    n = n + 1
+                    mems[id] = '__mem_'..n
+                end
+                return mems[id]
+            end)
+        end
+        return string.format('%016X', CACHE.hash(pre, common))
+    end
+
+    local dir = CEU.opts.cc_output..'.units'
+    os.execute('mkdir -p "'..dir..'"')
+
+    local objs = {}
+    local todo = {}
+    for k=0, units do
+        local obj  = dir..'/'..k..'.o'
+        local hash = HASH(k)
+        objs[#objs+1] = '"'..obj..'"'
+
+        local f = io.open(obj..'.hash')
+        local old = f and f:read'*a'
+        if f then
+            f:close()
+        end
+        local f = io.open(obj)
+        if f then
+            f:close()
+        end
+        if not (f and hash and old==hash) then
+            todo[#todo+1] = { k=k, obj=obj, hash=hash }
+        end
+    end
+
+    for i=1, #todo, CEU.opts.cc_jobs do
+        -- start up to "cc_jobs" compilers, then wait for all of them
+        local fs = {}
+        for j=i, math.min(#todo, i+CEU.opts.cc_jobs-1) do
+            local t = todo[j]
+            local cc = CEU.opts.cc_exe..' -xc -c -DCEU_UNIT='..t.k..' "'..CEU.opts.cc_input..'" '..
+                        '-o "'..t.obj..'" '..
+                        CEU.opts.cc_args..' 2>&1'
+            fs[#fs+1] = { t=t, f=assert(io.popen(cc)) }
+        end
+        for _, v in ipairs(fs) do
+            local err = v.f:read'*a'
+            local ok = v.f:close()
+            if not ok then
+                os.remove(v.t.obj..'.hash')
+            end
+            ASR(ok, err)
+            if err ~= '' then
+                DBG(err)
+            end
+            if v.t.hash then
+                local f = ASR(io.open(v.t.obj..'.hash','w'))
+                f:write(v.t.hash)
+                f:close()
+            end
+        end
+    end
+
+    local cc = CEU.opts.cc_exe..' '..table.concat(objs,' ')..' '..
+                '-o "'..CEU.opts.cc_output..'" '..
+                CEU.opts.cc_args..' 2>&1'
+    local f = assert(io.popen(cc))
+    local err = f:read'*a'
+    local ok = f:close()
+    ASR(ok, err)
+    DBG(err)
+end
+
+-------------------------------------------------------------------------------
+
+local units = tonumber(string.match(src, '\n#define CEU_UNITS_N +(%d+)\n') or 0)
+
+if units == 0 then
 --DBG(CEU.opts.cc_exe..' -xc '..CEU.opts.cc_input..' '..  '-o '..CEU.opts.cc_output..' '..  CEU.opts.cc_args..' 2>&1')
-local cc = CEU.opts.cc_exe..' -xc "'..CEU.opts.cc_input..'" '..
-            '-o "'..CEU.opts.cc_output..'" '..
-            CEU.opts.cc_args..' 2>&1'
-local f = assert(io.popen(cc))
-local err = f:read'*a'
-local ok = f:close()
-ASR(ok, err)
-DBG(err)
+    local cc = CEU.opts.cc_exe..' -xc "'..CEU.opts.cc_input..'" '..
+                '-o "'..CEU.opts.cc_output..'" '..
+                CEU.opts.cc_args..' 2>&1'
+    local f = assert(io.popen(cc))
+    local err = f:read'*a'
+    local ok = f:close()
+    ASR(ok, err)
+    DBG(err)
+else
+    UNITS(units)
+end
+
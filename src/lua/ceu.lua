@@ -3,40 +3,70 @@ optparse = dofile 'optparse.lua'
 dofile 'dbg.lua'
 DBG,ASR = DBG1,ASR1
 dofile 'cmd.lua'
+dofile 'prof.lua'
+dofile 'cache.lua'
 if CEU.opts.pre then
     dofile 'pre.lua'
+    PROF.phase 'pre'
 end
-if CEU.opts.ceu then
+if CEU.opts.ceu and (not CACHE.get()) then
     dofile 'lines.lua'
+    PROF.phase 'lines'
     dofile 'parser.lua'
+    PROF.phase 'parser'
     dofile 'ast.lua'
+    PROF.phase 'ast'
     DBG,ASR = DBG2,ASR2
     dofile 'adjs.lua'
+    PROF.phase 'adjs'
     dofile 'types.lua'
+    PROF.phase 'types'
     dofile 'exps.lua'
+    PROF.phase 'exps'
     dofile 'dcls.lua'
+    PROF.phase 'dcls'
     dofile 'inlines.lua'
+    PROF.phase 'inlines'
     dofile 'consts.lua'
+    PROF.phase 'consts'
     dofile 'fins.lua'
+    PROF.phase 'fins'
     dofile 'spawns.lua'
+    PROF.phase 'spawns'
     dofile 'stmts.lua'
+    PROF.phase 'stmts'
     dofile 'inits.lua'
+    PROF.phase 'inits'
     dofile 'ptrs.lua'
+    PROF.phase 'ptrs'
     dofile 'scopes.lua'
+    PROF.phase 'scopes'
     dofile 'tight_.lua'
+    PROF.phase 'tight_'
     dofile 'props_.lua'
+    PROF.phase 'props_'
     dofile 'trails.lua'
+    PROF.phase 'trails'
     dofile 'labels.lua'
+    PROF.phase 'labels'
     dofile 'vals.lua'
+    PROF.phase 'vals'
     dofile 'multis.lua'
+    PROF.phase 'multis'
     dofile 'mems.lua'
+    PROF.phase 'mems'
     dofile 'codes.lua'
+    PROF.phase 'codes'
+    CACHE.put(CODES.c)
 end
 DBG,ASR = DBG1,ASR1
 if CEU.opts.env then
     dofile 'env.lua'
+    PROF.phase 'env'
 end
 if CEU.opts.cc then
     dofile 'cc.lua'
+    PROF.phase 'cc'
 end
+PROF.report()
 --AST.dump(AST.root)
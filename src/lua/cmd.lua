@@ -26,6 +26,16 @@ Options:
     --ceu-input=FILE                    input file to compile (Céu source)
     --ceu-output=FILE                   output source file to generate (C source)
     --ceu-line-directives=BOOL          insert `#line` directives in the C output (default `true`)
+    --ceu-layout-aligned=BOOL           align `data` fields and sort fields by alignment (default `false`)
+    --ceu-inline-budget=N               inline `code/await` abstractions whose copies add up to N AST nodes (default `-1`: none)
+    --ceu-input-tables=BOOL             generate tables of the trails that may await each input (default `false`)
+    --ceu-async-budget=N                run N iterations of loops in `async` blocks before yielding to inputs (default `1`)
+    --ceu-profile=BOOL                  report time, memory, and size of each phase to stderr (default `false`)
+    --ceu-code-functions=BOOL           generate each `code` abstraction as a separate C function (default `false`)
+    --ceu-output-functions=BOOL         emit outputs as calls to `ceu_output_<ID>` functions of the environment (default `false`)
+    --ceu-units=N                       split `code` abstractions into N separate compilation units (default `0`)
+    --ceu-cache=DIR                     reuse the output of previous compilations of the same input from directory DIR
+    --ceu-label-map=FILE                write the source line and C lines of each label (`CEU_LABEL_*`) to FILE
 
     --ceu-features-trace=BOOL           enable trace support (default `false`)
     --ceu-features-exception=BOOL       enable exceptions support (default `false`)
@@ -35,6 +45,12 @@ Options:
     --ceu-features-thread=BOOL          enable `async/thread` support (default `false`)
     --ceu-features-isr=BOOL             enable `async/isr` support (default `false`)
     --ceu-features-pause=BOOL           enable `pause/if` support (default `false`)
+    --ceu-features-stats=BOOL           enable runtime statistics (`ceu_stats`) (default `false`)
+    --ceu-features-record=BOOL          enable input recording (`CEU_CALLBACK_RECORD`) (default `false`)
+    --ceu-features-hits=BOOL            enable hit counts of labels (`CEU_APP.hits`) (default `false`)
+    --ceu-features-output-batch=BOOL    enable batched outputs (`CEU_CALLBACK_OUTPUT_BATCH`) (default `false`)
+    --ceu-features-snapshot=BOOL        enable snapshots of the program state (`ceu_snapshot_save`) (default `false`)
+    --ceu-features-callback-table=BOOL  enable per-command callbacks (`ceu_callback_register_cmd`) (default `false`)
 
     --ceu-err-unused=OPT                effect for unused identifier: error|warning|pass
     --ceu-err-unused-native=OPT                    unused native identifier
@@ -56,6 +72,7 @@ Options:
     --cc-args=ARGS                      compiler arguments
     --cc-input=FILE                     input file to compile (C source)
     --cc-output=FILE                    output file to generate (binary)
+    --cc-jobs=N                         number of compilation units to compile in parallel (default `4`)
 
 http://www.ceu-lang.org/
 
@@ -134,6 +151,14 @@ do
     local T = {
         ceu_output             = { tostring,  '-'     },
         ceu_line_directives    = { toboolean, 'true'  },
+        ceu_layout_aligned     = { toboolean, 'false' },
+        ceu_inline_budget      = { tonumber,  '-1'    },
+        ceu_input_tables       = { toboolean, 'false' },
+        ceu_async_budget       = { tonumber,  '1'     },
+        ceu_profile            = { toboolean, 'false' },
+        ceu_code_functions     = { toboolean, 'false' },
+        ceu_output_functions   = { toboolean, 'false' },
+        ceu_units              = { tonumber,  '0'     },
         ceu_features_trace     = { toboolean, 'false' },
         ceu_features_exception = { toboolean, 'false' },
         ceu_features_dynamic   = { toboolean, 'false' },
@@ -142,8 +167,16 @@ do
         ceu_features_thread    = { toboolean, 'false' },
         ceu_features_isr       = { toboolean, 'false' },
         ceu_features_pause     = { toboolean, 'false' },
+        ceu_features_stats     = { toboolean, 'false' },
+        ceu_features_record    = { toboolean, 'false' },
+        ceu_features_hits      = { toboolean, 'false' },
+        ceu_features_output_batch = { toboolean, 'false' },
+        ceu_features_snapshot  = { toboolean, 'false' },
+        ceu_features_callback_table = { toboolean, 'false' },
 
         env_output             = { tostring,  '-'     },
+
+        cc_jobs                = { tonumber,  '4'     },
     }
 
     for k, t in pairs(T) do
@@ -177,6 +210,17 @@ if CEU.opts.ceu then
     if CEU.opts.ceu_features_lua or CEU.opts.ceu_features_thread then
         ASR(CEU.opts.ceu_features_dynamic, 'expected option `ceu-features-dynamic`')
     end
+    if CEU.opts.ceu_output_functions then
+        ASR(not CEU.opts.ceu_features_output_batch, 'invalid option `ceu-output-functions` : incompatible with `ceu-features-output-batch`')
+    end
+    if CEU.opts.ceu_features_snapshot then
+        ASR(not CEU.opts.ceu_features_dynamic, 'invalid option `ceu-features-snapshot` : incompatible with `ceu-features-dynamic`')
+    end
+    ASR(CEU.opts.ceu_async_budget >= 1, 'invalid option `ceu-async-budget` : expected a positive number')
+    if CEU.opts.ceu_units > 0 then
+        ASR(not CEU.opts.ceu_features_isr, 'invalid option `ceu-units` : incompatible with `ceu-features-isr`')
+        CEU.opts.ceu_code_functions = true
+    end
 else
     check_no('ceu')
 end
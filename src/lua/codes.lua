@@ -1,13 +1,44 @@
 CODES = {
     native  = { pre='', pos='' },
-    threads = '',
-    isrs    = '',
+    threads = {},
+    isrs    = {},
     exts    = {},
+    funcs   = {},   -- `code` abstractions in separate functions (`--ceu-units`)
+    inputs  = {},   -- trails that may await inputs (`--ceu-input-tables`)
+    abss    = {},   -- `code` instantiated with `__abs` (`--ceu-input-tables`)
 }
 
+-- Generated code is kept as "ropes": each node's `me.code` is a list of
+-- strings and of references to the ropes of its children, which are only
+-- flattened once when the output file is written.
+-- (Repeated `..` over whole subtrees is quadratic on large programs.)
+
+local function FLAT (rope, buf)
+    buf = buf or {}
+    for _, v in ipairs(rope) do
+        if type(v) == 'table' then
+            FLAT(v, buf)
+        else
+            buf[#buf+1] = v
+        end
+    end
+    return buf
+end
+
+function CODES.flat (rope)
+    return table.concat(FLAT(rope))
+end
+
 local function LINE_DIRECTIVE (me)
     if CEU.opts.ceu_line_directives then
-        return [[
+        local file = ''
+        if CEU.opts.ceu_features_trace then
+            -- see `CEU_TRACE`
+            file = [[
+#undef  CEU_TRACE_FILE
+#define CEU_TRACE_FILE ]]..CEU.trace_file(me.ln[1])..'\n'
+        end
+        return file..[[
 #line ]]..me.ln[2]..' "'..me.ln[1]..[["
 ]]
     else
@@ -15,18 +46,27 @@ local function LINE_DIRECTIVE (me)
     end
 end
 
-local function LINE (me, line)
-    me.code = me.code..'\n'..[[
+local function ROPE (rope, ...)
+    for i=1, select('#',...) do
+        rope[#rope+1] = select(i, ...)
+    end
+end
+
+-- LINE(me, str1, rope2, str3, ...)
+--  - strings are appended as is
+--  - ropes (e.g., `sub.code`) are appended by reference
+local function LINE (me, ...)
+    ROPE(me.code, '\n'..[[
 /* ]]..me.tag..' (n='..me.n..', ln='..me.ln[2]..[[) */
-]]
+]])
     if CEU.opts.ceu_line_directives then
-        me.code = me.code..'\n'..LINE_DIRECTIVE(me)
+        ROPE(me.code, '\n'..LINE_DIRECTIVE(me))
     end
-    me.code = me.code..line
+    ROPE(me.code, ...)
 end
 
 local function CONC (me, sub)
-    me.code = me.code..sub.code
+    ROPE(me.code, sub.code)
 end
 
 local function CONC_ALL (me)
@@ -47,7 +87,11 @@ local function NO_LBL (me)
     return AST.par(me,'Async_Thread') or AST.par(me,'Async_Isr') or AST.par(me,'Ext_impl')
 end
 
+-- label id -> source line of its `case` (`--ceu-label-map`, `--ceu-features-hits`)
+local LNS = {}
+
 local function CASE (me, lbl)
+    LNS[lbl.id] = LNS[lbl.id] or me.ln
     if NO_LBL(me) then
         LINE(me, lbl.id..':;\n')
     else
@@ -69,6 +113,17 @@ end
 
 local function CLEAR (me, lbl)
     lbl = lbl or me.lbl_clr
+
+    -- nothing to visit (see `has_fins` in "trails.lua"): resets all trails in
+    -- place and continues as if resumed from the CLEAR continuation
+    if not me.has_fins then
+        LINE(me, [[
+memset(&_ceu_mem->_trails[]]..me.trails[1]..[[], 0, ]]..(me.trails[2]-me.trails[1]+1)..[[*sizeof(tceu_trl));
+*_ceu_trlK = ]]..me.trails[1]..[[;
+]])
+        return
+    end
+
     LINE(me, [[
 _ceu_mem->_trails[]]..me.trails[1]..[[].evt.id = CEU_INPUT__STACKED;
 _ceu_mem->_trails[]]..me.trails[1]..[[].level  = _ceu_level;
@@ -102,12 +157,44 @@ _ceu_mem->_trails[]]..(T.trail or me.trails[1])..'].'..id..' = '..val..[[;
 return ]]..(ret or 0)..[[;
 ]])
     if T.lbl then
+        LNS[T.lbl] = LNS[T.lbl] or me.ln
         LINE(me, [[
 case ]]..T.lbl..[[:;
 ]])
     end
 end
 
+-- `--ceu-input-tables`: records, for the enclosing `code` (or the root),
+-- which trails may await which inputs (see `CODES.inputs_tables`)
+--  - id:   input awaited on trail `trl`
+--  - abs:  `code` propagated on trail `trl` (all inputs it may await)
+--  - full: scan all trails (`Pause_If`, unknown events)
+local function INPUTS (me, T)
+    if not CEU.opts.ceu_input_tables then
+        return
+    end
+    local Code = AST.par(me,'Code') or AST.root
+    local t = Code.__codes_inputs
+    if not t then
+        t = { trails={}, calls={}, reach={}, full=false, all=false }
+        Code.__codes_inputs = t
+        CODES.inputs[#CODES.inputs+1] = t
+    end
+    if T.id then
+        t.reach[T.id] = true
+        t.trails[T.id] = t.trails[T.id] or {}
+        local ts = t.trails[T.id]
+        ts[#ts+1] = T.trl
+    end
+    if T.abs then
+        t.calls[#t.calls+1] = { trl=T.trl, abs=T.abs }
+    end
+    if T.full then
+        t.full = true
+        t.all  = true
+    end
+end
+
 function SET (me, to, fr, to_ok, fr_ok, to_ctx, fr_ctx)
     local fr_val = fr
     local to_val = to
@@ -169,7 +256,7 @@ function SET (me, to, fr, to_ok, fr_ok, to_ctx, fr_ctx)
             if not MEMS.datas.casts[name] then
                 MEMS.datas.casts[name] = true
                 MEMS.datas.casts[#MEMS.datas.casts+1] = [[
-]]..TYPES.toc(to_tp)..' '..name..[[ (]]..fr_tp..[[ x)
+static inline ]]..TYPES.toc(to_tp)..' '..name..[[ (]]..fr_tp..[[ x)
 {
     return (*(]]..TYPES.toc(to_tp)..[[*)&x);
 }
@@ -212,7 +299,7 @@ CODES.F = {
     Every    = CONC_ALL,
 
     Node__PRE = function (me)
-        me.code = ''
+        me.code = {}
     end,
 
     ROOT__PRE = function (me)
@@ -250,9 +337,9 @@ CODES.F = {
         local c, t, f = unpack(me)
         LINE(me, [[
 if (]]..V(c)..[[) {
-    ]]..t.code..[[
+    ]], t.code, [[
 } else {
-    ]]..f.code..[[
+    ]], f.code, [[
 }
 ]])
     end,
@@ -328,7 +415,7 @@ ceu_vector_setmax(&]]..V(ID_int,ctx)..[[, 0, 0);
 
     Pool_Init = function (me)
         local ID_int = unpack(me)
-        local _, tp, _, dim = unpack(ID_int.dcl)
+        local _, tp, _, dim, max = unpack(ID_int.dcl)
         LINE(me, [[
 {
     /* first.nxt = first.prv = &first; */
@@ -337,6 +424,7 @@ ceu_vector_setmax(&]]..V(ID_int,ctx)..[[, 0, 0);
 };
 ]]..V(ID_int)..[[.up_mem = _ceu_mem;
 ]]..V(ID_int)..[[.n_traversing = 0;
+]]..V(ID_int)..[[.no_fins = ]]..((TYPES.abs_dcl(tp,'Code').no_fins and 1) or 0)..[[;
 ]])
         if dim == '[]' then
             LINE(me, [[
@@ -347,17 +435,35 @@ ceu_vector_setmax(&]]..V(ID_int,ctx)..[[, 0, 0);
 ceu_pool_init(&]]..V(ID_int)..'.pool, '..V(dim)..[[,
               sizeof(tceu_code_mem_dyn)+sizeof(]]..TYPES.toc(tp)..[[),
               (byte**)&]]..CUR(ID_int.dcl.id_..'_queue')..', (byte*)&'..CUR(ID_int.dcl.id_..'_buf')..[[);
+]])
+        end
+        if CEU.opts.ceu_features_dynamic then
+            local over = '0'
+            if max == '[]' then
+                over = '((usize)-1)'
+            elseif max then
+                over = '(('..V(max)..' > '..V(dim)..') ? '..V(max)..'-'..V(dim)..' : 0)'
+            end
+            LINE(me, [[
+]]..V(ID_int)..[[.over_n   = 0;
+]]..V(ID_int)..[[.over_max = ]]..over..[[;
 ]])
         end
         LINE(me, [[
 _ceu_mem->_trails[]]..ID_int.dcl.trails[1]..[[].evt.id  = CEU_INPUT__PROPAGATE_POOL;
 _ceu_mem->_trails[]]..ID_int.dcl.trails[1]..[[].evt.pak = &]]..V(ID_int)..[[;
 ]])
+        INPUTS(me, { trl=ID_int.dcl.trails[1], abs=TYPES.abs_dcl(tp,'Code') })
     end,
     Pool_Finalize = function (me)
         local ID_int = unpack(me)
-        LINE(me, [[
+        local _,_,_,dim = unpack(ID_int.dcl)
+        if dim == '[]' then
+            LINE(me, [[
 ceu_assert(]]..V(ID_int,ctx)..[[.pool.queue == NULL, "bug found");
+]])
+        end
+        LINE(me, [[
 ]]..V(ID_int,ctx)..[[.n_traversing = 0;
 ceu_code_mem_dyn_gc(&]]..V(ID_int,ctx)..[[);
 ]])
@@ -370,13 +476,13 @@ ceu_code_mem_dyn_gc(&]]..V(ID_int,ctx)..[[);
         local stmts = AST.asr(block,'Block', 1,'Stmts')
         local body = AST.asr(stmts[#stmts], 'Do')
         local inout = unpack(ext)
-        CODES.exts[#CODES.exts+1] = [[
+        CODES.exts[#CODES.exts+1] = { [[
 case ]]..ext.id_..[[: {
     tceu_]]..inout..[[_mem_]]..ext.id..[[ _ceu_loc;
-]]..body.code..[[
+]], body.code, [[
     break;
 }
-]]
+]] }
     end,
 
     Code = function (me)
@@ -396,6 +502,13 @@ if (0)
         LINE(me, [[
 }
 ]])
+
+        -- `--ceu-code-functions`: move to its own function (see `CODES.functions`)
+        if CEU.opts.ceu_code_functions then
+            CODES.funcs[#CODES.funcs+1] = me
+            me.code_func = me.code
+            me.code = {}
+        end
     end,
 
     Code_Finalize = function (me)
@@ -434,7 +547,7 @@ if (_ceu_mem->pak != NULL) {
 }
 #endif
 
-ceu_stack_clear(_ceu_cur, _ceu_mem);
+ceu_stack_clear(_ceu_mem);
 
 if (_ceu_mem->has_term) {
     _ceu_mem->has_term = 0;
@@ -463,12 +576,11 @@ assert(not obj, 'not implemented')
     ]]..mem..[[->_mem.up_mem = ]]..((pak=='NULL' and '_ceu_mem') or (pak..'->up_mem'))..[[;
     ]]..mem..[[->_mem.depth  = ]]..ID_abs.dcl.depth..[[;
     ]]..mem..[[->_mem.has_term = 0;
+    ]]..mem..[[->_mem.stk    = NULL;
 ]]
         if CEU.opts.ceu_features_trace then
             ret = ret .. LINE_DIRECTIVE(me) .. [[
-    ]]..mem..[[->_mem.trace.up   = &_ceu_mem->trace;
-    ]]..mem..[[->_mem.trace.file = __FILE__;
-    ]]..mem..[[->_mem.trace.line = __LINE__-2;
+    ]]..mem..[[->_mem.trace  = CEU_TRACE_SITE(CEU_TRACE_FILE,__LINE__);
 ]]
         end
         if CEU.opts.ceu_features_exception then
@@ -482,6 +594,16 @@ assert(not obj, 'not implemented')
 ]]
         end
 
+        if CEU.opts.ceu_input_tables then
+            if not CODES.abss[ID_abs.dcl.id_] then
+                CODES.abss[ID_abs.dcl.id_] = true
+                CODES.abss[#CODES.abss+1] = ID_abs.dcl
+            end
+            ret = ret .. [[
+    ]]..mem..[[->_mem.inputs   = CEU_INPUTS_]]..ID_abs.dcl.id_..[[;
+]]
+        end
+
         ret = ret .. [[
     ]]..mem..[[->_mem.trails_n = ]]..ID_abs.dcl.trails_n..[[;
     memset(&]]..mem..[[->_mem._trails, 0, ]]..ID_abs.dcl.trails_n..[[*sizeof(tceu_trl));
@@ -516,6 +638,9 @@ _ceu_mem->_trails[]]..(to.dcl.trails[1])..[[].evt.mem =  &]]..CUR('__mem_'..me.n
     end,
 
     Abs_Await = function (me)
+        local _, Abs_Cons = unpack(me)
+        local _, ID_abs = unpack(Abs_Cons)
+        INPUTS(me, { trl=me.trails[1], abs=ID_abs.dcl })
         HALT(me, {
             { ['evt.id']  = 'CEU_INPUT__PROPAGATE_CODE' },
             { ['evt.mem'] = '(tceu_code_mem*) &'..CUR('__mem_'..me.n) },
@@ -530,7 +655,15 @@ _ceu_mem->_trails[]]..(to.dcl.trails[1])..[[].evt.mem =  &]]..CUR('__mem_'..me.n
         local _, Abs_Cons, pool = unpack(me)
         local obj, ID_abs, Abslist = unpack(Abs_Cons)
 assert(not obj, 'not implemented')
-        local alias,_,_,dim = unpack(pool.info.dcl)
+        local alias,_,_,dim,max = unpack(pool.info.dcl)
+        local size = 'sizeof(tceu_code_mem_dyn) + sizeof(tceu_code_mem_'..ID_abs.dcl.id_..')'
+        local overflow = [[
+#ifdef CEU_FEATURES_DYNAMIC
+    if (__ceu_new == NULL) {
+        __ceu_new = ceu_code_mem_dyn_overflow(&]]..V(pool)..', '..size..[[);
+    }
+#endif
+]]
 
         LINE(me, [[
 {
@@ -550,6 +683,7 @@ assert(not obj, 'not implemented')
 #endif
     {
         __ceu_new = (tceu_code_mem_dyn*) ceu_pool_alloc(&]]..V(pool)..[[.pool);
+]]..overflow..[[
     }
 ]])
         elseif dim == '[]' then
@@ -565,6 +699,9 @@ assert(not obj, 'not implemented')
             LINE(me, [[
     __ceu_new = (tceu_code_mem_dyn*) ceu_pool_alloc(&]]..V(pool)..[[.pool);
 ]])
+            if max then
+                LINE(me, overflow)
+            end
         end
 
         local set = AST.par(me,'Set_Abs_Spawn')
@@ -583,6 +720,11 @@ assert(not obj, 'not implemented')
         LINE(me, [[
     if (__ceu_new != NULL) {
         __ceu_new->is_alive = 1;
+#ifdef CEU_FEATURES_STATS
+        if (++CEU_APP.stats.pool_n > CEU_APP.stats.pool_max) {
+            CEU_APP.stats.pool_max = CEU_APP.stats.pool_n;
+        }
+#endif
         __ceu_new->nxt = &]]..V(pool)..[[.first;
         ]]..V(pool)..[[.first.prv->nxt = __ceu_new;
         __ceu_new->prv = ]]..V(pool)..[[.first.prv;
@@ -600,6 +742,9 @@ assert(not obj, 'not implemented')
         }, 1)
         LINE(me, [[
     } else {
+#ifdef CEU_FEATURES_STATS
+        CEU_APP.stats.pool_fails++;
+#endif
 ]])
         if set and to.dcl[1]=='&' then
             LINE(me, [[
@@ -666,6 +811,7 @@ if (0) {
         if i.tag ~= 'ID_any' then
             local abs = TYPES.abs_dcl(i.info.tp,'Code')
             SET(me, i, '((tceu_code_mem_'..abs.id_..'*)'..cur..'->mem)', nil,true, {is_bind=true},nil)
+            LNS[me.lbl_null.id] = me.ln
             LINE(me, [[
             _ceu_mem->_trails[]]..(me.trails[1]+2)..[[].evt.id    = CEU_INPUT__CODE_TERMINATED;
             _ceu_mem->_trails[]]..(me.trails[1]+2)..[[].evt.mem   = ]]..cur..'->mem'..[[;
@@ -719,6 +865,7 @@ if (0) {
 
     Pause_If = function (me)
         local e, body = unpack(me)
+        INPUTS(me, { full=true })
         LINE(me, [[
 _ceu_mem->_trails[]]..me.trails[1]..[[].evt.id     = CEU_INPUT__PAUSE_BLOCK;
 _ceu_mem->_trails[]]..me.trails[1]..[[].pse_evt    = ]]..V(e)..[[;
@@ -829,15 +976,29 @@ ceu_assert(]]..CUR('__max_'..me.n)..' < '..V(max)..[[, "`loop` overflow");
     __loop_async = function (me)
         local async = AST.par(me, 'Async')
         if async then
+            -- `--ceu-async-budget`: yield only every N iterations (see `CEU_ASYNC_BUDGET`)
+            local budget = (CEU.opts.ceu_async_budget > 1)
+            if budget then
+                LINE(me, [[
+if (--CEU_APP.async_budget == 0) {
+    CEU_APP.async_budget = CEU_ASYNC_BUDGET;
+]])
+            end
             LINE(me, [[
 CEU_APP.async_pending = 1;
 ceu_callback_num_ptr(CEU_CALLBACK_ASYNC_PENDING, 0, NULL, CEU_TRACE(0));
 ]])
+            INPUTS(me, { trl=me.trails[1], id='CEU_INPUT__ASYNC' })
             HALT(me, {
                 { ['evt.id'] = 'CEU_INPUT__ASYNC' },
                 { lbl        = me.lbl_asy.id },
                 lbl = me.lbl_asy.id,
             })
+            if budget then
+                LINE(me, [[
+}
+]])
+            end
         end
     end,
 
@@ -850,7 +1011,7 @@ ceu_callback_num_ptr(CEU_CALLBACK_ASYNC_PENDING, 0, NULL, CEU_TRACE(0));
 ]]..max.ini..[[
 while (1) {
     ]]..max.chk..[[
-    ]]..body.code..[[
+    ]], body.code, [[
 ]])
         CASE(me, me.lbl_cnt)
 
@@ -929,7 +1090,7 @@ while (1) {
         end
         LINE(me, [[
     ]]..max.chk..[[
-    ]]..body.code..[[
+    ]], body.code, [[
 ]])
         CASE(me, me.lbl_cnt)
             assert(body.trails[1]==me.trails[1] and body.trails[2]==me.trails[2])
@@ -1329,6 +1490,11 @@ do {
 
     Await_Ext = function (me)
         local ID_ext = unpack(me)
+        if ID_ext.dcl[1] == 'input' then
+            INPUTS(me, { trl=me.trails[1], id=ID_ext.dcl.id_ })
+        else
+            INPUTS(me, { full=true })
+        end
         HALT(me, {
             { evt = V(ID_ext) },
             { lbl = me.lbl_out.id },
@@ -1377,9 +1543,41 @@ tceu_]]..inout..'_'..ID_ext.dcl.id..[[ __ceu_ps;
 
         if inout == 'output' then
             local set = AST.par(me,'Set_Emit_Ext_emit')
+
+            -- `--ceu-features-output-batch`: only outputs w/o results, aliases,
+            -- or implementations, and emitted from reactions
+            --  - the others flush the batch first, to keep the order
+            --  - except from threads and ISRs, which would race with the
+            --    reaction filling the batch, and are not ordered with it
+            if CEU.opts.ceu_features_output_batch then
+                local dcl = ID_ext.dcl
+                local is_alias = false
+                for i=1, #Typelist do
+                    is_alias = is_alias or (dcl.are_aliases and dcl.are_aliases[i])
+                end
+                if AST.par(me,'Async_Thread') or AST.par(me,'Async_Isr') then
+                    -- synchronous, batch untouched
+                elseif NO_LBL(me) or set or is_alias or AST.par(dcl,'Ext_impl') then
+                    LINE(me, [[
+ceu_output_flush();
+]])
+                else
+                    local size = (ps=='NULL' and '0') or 'sizeof(__ceu_ps)'
+                    LINE(me, [[
+ceu_output_batch(]]..V(ID_ext)..'.id, '..ps..', '..size..[[);
+}
+]])
+                    return
+                end
+            end
+
             local cb = [[
 (ceu_callback_num_ptr(CEU_CALLBACK_OUTPUT, ]]..V(ID_ext)..'.id, '..ps..[[, CEU_TRACE(0)), ceu_callback_ret.num);
 ]]
+            -- `--ceu-output-functions`: direct call (see `MEMS.exts.types`)
+            if CEU.opts.ceu_output_functions and (not AST.par(ID_ext.dcl,'Ext_impl')) then
+                cb = 'ceu_output_'..ID_ext.dcl.id..'('..(ps=='NULL' and '' or ps)..');\n'
+            end
             if set then
                 local _, to = unpack(set)
                 SET(me, to, cb, nil,true)
@@ -1388,6 +1586,7 @@ tceu_]]..inout..'_'..ID_ext.dcl.id..[[ __ceu_ps;
             end
         else
             if AST.par(me, 'Async') then
+                INPUTS(me, { trl=me.trails[1], id='CEU_INPUT__ASYNC' })
                 LINE(me, [[
 CEU_APP.async_pending = 1;
 ceu_callback_num_ptr(CEU_CALLBACK_ASYNC_PENDING, 0, NULL, CEU_TRACE(0));
@@ -1398,6 +1597,9 @@ _ceu_mem->_trails[]]..me.trails[1]..[[].lbl    = ]]..me.lbl_out.id..[[;
     tceu_range __ceu_range = { &CEU_APP.root._mem, 0, CEU_TRAILS_N-1 };
     _ceu_nxt->evt    = __ceu_evt;
     _ceu_nxt->range  = __ceu_range;
+#ifdef CEU_FEATURES_STATS
+    CEU_APP.stats.reactions[]]..V(ID_ext)..[[.id]++;
+#endif
 ]])
 
                 if #List_Exp > 0 then
@@ -1508,6 +1710,7 @@ ceu_wclock(]]..V(e)..', &'..wclk..[[, NULL, CEU_TRACE(0));
 
 _CEU_HALT_]]..me.n..[[_:
 ]])
+        INPUTS(me, { trl=me.trails[1], id='CEU_INPUT__WCLOCK' })
         HALT(me, {
             { ['evt.id'] = 'CEU_INPUT__WCLOCK' },
             { lbl        = me.lbl_out.id },
@@ -1527,6 +1730,7 @@ _CEU_HALT_]]..me.n..[[_:
     Emit_Wclock = function (me)
         local e = unpack(me)
         if AST.par(me,'Async') then
+            INPUTS(me, { trl=me.trails[1], id='CEU_INPUT__ASYNC' })
             LINE(me, [[
 {
     s32 __ceu_dt = ]]..V(e)..[[;
@@ -1542,6 +1746,9 @@ _CEU_HALT_]]..me.n..[[_:
         tceu_range __ceu_range = { &CEU_APP.root._mem, 0, CEU_TRAILS_N-1 };
         _ceu_nxt->evt      = __ceu_evt;
         _ceu_nxt->range    = __ceu_range;
+#ifdef CEU_FEATURES_STATS
+        CEU_APP.stats.reactions[CEU_INPUT__WCLOCK]++;
+#endif
         ceu_params_cpy(_ceu_nxt, &__ceu_dt, sizeof(__ceu_dt));
         return 1;
     }
@@ -1580,6 +1787,7 @@ _CEU_HALT_]]..me.n..[[_:
 CEU_APP.async_pending = 1;
 ceu_callback_num_ptr(CEU_CALLBACK_ASYNC_PENDING, 0, NULL, CEU_TRACE(0));
 ]])
+        INPUTS(me, { trl=me.trails[1], id='CEU_INPUT__ASYNC' })
         HALT(me, {
             { ['evt.id'] = 'CEU_INPUT__ASYNC' },
             { lbl        = me.lbl_in.id },
@@ -1653,6 +1861,7 @@ if (]]..v..[[ != NULL)
         while (! ]]..v..[[->has_started);   /* wait copy of "p" */
         while (1) {
 ]])
+        INPUTS(me, { trl=me.trails[1]+1, id='CEU_INPUT__THREAD' })
         HALT(me, {
             trail = me.trails[1]+1,
             { ['evt.id'] = 'CEU_INPUT__THREAD' },
@@ -1673,10 +1882,10 @@ if (]]..v..[[ != NULL)
 ]])
 
         -- function definition
-        CODES.threads = CODES.threads .. [[
+        ROPE(CODES.threads, [[
 static CEU_THREADS_PROTOTYPE(_ceu_thread_]]..me.n..[[,void* __ceu_p)
 {
-#define CEU_TRACE(n) ((tceu_trace){&_ceu_mem->trace,__FILE__,__LINE__+(n)})
+#define CEU_TRACE(n) ((tceu_trace){_ceu_mem,CEU_TRACE_SITE(CEU_TRACE_FILE,__LINE__+(n))})
     /* start thread */
 
     /* copy param */
@@ -1685,7 +1894,7 @@ static CEU_THREADS_PROTOTYPE(_ceu_thread_]]..me.n..[[,void* __ceu_p)
     _ceu_p.thread->has_started = 1;
 
     /* body */
-    ]]..blk.code..[[
+    ]], blk.code, [[
 #if 0
     goto ]]..me.lbl_abt.id..[[; /* avoids "not used" warning */
 #endif
@@ -1702,7 +1911,7 @@ static CEU_THREADS_PROTOTYPE(_ceu_thread_]]..me.n..[[,void* __ceu_p)
     CEU_THREADS_RETURN(NULL);
 #undef CEU_TRACE
 }
-]]
+]])
     end,
 
     Async_Isr = function (me)
@@ -1721,16 +1930,16 @@ static CEU_THREADS_PROTOTYPE(_ceu_thread_]]..me.n..[[,void* __ceu_p)
 }
 ]])
 
-        CODES.isrs = CODES.isrs .. [[
+        ROPE(CODES.isrs, [[
 typedef struct tceu_isr_mem_]]..me.n..[[ {
     ]]..me.mems.mem..[[
 } tceu_isr_mem_]]..me.n..[[;
 
 void CEU_ISR_]]..me.n..[[ (tceu_code_mem* _ceu_mem) {
     tceu_isr_mem_]]..me.n..[[ _ceu_loc;
-    ]]..blk.code..[[
+    ]], blk.code, [[
 }
-]]
+]])
     end,
 
     Finalize_Async_Isr = function (me)
@@ -1948,22 +2157,288 @@ _CEU_LUA_ERR_]]..me.n..[[:;
 
 local function SUB (str, from, to)
     assert(to, from)
-    local i,e = string.find(str, from, 1, true)
-    if i then
-        return SUB(string.sub(str,1,i-1) .. to .. string.sub(str,e+1),
-                   from, to)
-    else
-        return str
+    if CEU.opts.ceu_profile then
+        PROF.section(string.match(from,'^=== (.-) ===$'), to)
     end
+    local ret = {}
+    local pos = 1
+    while true do
+        local i,e = string.find(str, from, pos, true)
+        if not i then
+            break
+        end
+        ret[#ret+1] = string.sub(str, pos, i-1)
+        ret[#ret+1] = to
+        pos = e + 1
+    end
+    ret[#ret+1] = string.sub(str, pos)
+    return table.concat(ret)
 end
 
 AST.visit(CODES.F)
 
+-- `--ceu-code-functions=true` (also implied by `--ceu-units=N`):
+--  - each `code` goes to its own function `ceu_lbl_<id>`, which only holds
+--    the labels of that `code`
+--  - `CEU_LABELS_FUNCS` maps each label to the index of its function in
+--    `CEU_CODES_FUNCS` (`0` for labels of the main program), and `ceu_lbl`
+--    dispatches through it before switching
+--    (a small constant table instead of a function pointer in each `tceu_trl`)
+--  - with `--ceu-units=N`, functions are distributed among units 1..N by the
+--    hash of their identifiers, so that edits do not move the other codes
+--    (unit 0 holds the runtime, the main program, and the table)
+function CODES.functions ()
+    if not CEU.opts.ceu_code_functions then
+        return '', ''
+    end
+
+    local N = CEU.opts.ceu_units
+
+    local params = 'tceu_nstk _ceu_level, tceu_stk* _ceu_cur, tceu_stk* _ceu_nxt, '..
+                   'tceu_code_mem* _ceu_mem, tceu_nlbl _ceu_lbl, tceu_ntrl* _ceu_trlK'
+    local protos = {
+        'typedef int (*tceu_lbl_f) ('..params..');\n',
+    }
+    local funcs = {}
+    for _, me in ipairs(CODES.funcs) do
+        local body = CODES.flat(me.code_func)
+
+        local unit = N>0 and CACHE.hash(me.id_)%N+1
+        if N > 0 then
+            funcs[#funcs+1] = '#if defined(CEU_UNIT_ALL) || (CEU_UNIT == '..unit..')\n'
+        end
+
+        protos[#protos+1] = 'CEU_UNIT_STATIC int ceu_lbl_'..me.id_..' ('..params..');\n'
+        funcs[#funcs+1] = [[
+CEU_UNIT_STATIC int ceu_lbl_]]..me.id_..' ('..params..[[)
+{
+#define CEU_TRACE(n) ((tceu_trace){_ceu_mem,CEU_TRACE_SITE(CEU_TRACE_FILE,__LINE__+(n))})
+_CEU_LBL_:
+    CEU_LBL_HIT();
+    switch (_ceu_lbl) {
+        default:
+            ceu_assert(0, "bug found");     /* label of another function */
+            return 0;
+]]..body..[[
+    }
+    return 0;
+#undef CEU_TRACE
+}
+]]
+        if N > 0 then
+            funcs[#funcs+1] = '#endif /* CEU_UNIT == '..unit..' */\n'
+        end
+    end
+
+    -- label -> index of function (1-based, `0` for none)
+    local idxs = {}
+    local fs = {}
+    for i, me in ipairs(CODES.funcs) do
+        idxs[me] = i
+        fs[#fs+1] = '    ceu_lbl_'..me.id_..',\n'
+    end
+    local tbl = { '0,' }   -- CEU_LABEL_NONE
+    for _, lbl in ipairs(LABELS.list) do
+        local idx = lbl.code and idxs[lbl.code]
+        if (not idx) and lbl.code and lbl[2] then
+            -- entry label listed with a previous prototype
+            for _, me in ipairs(CODES.funcs) do
+                if me.lbl.id == lbl.id then
+                    idx = idxs[me]
+                end
+            end
+        end
+        tbl[#tbl+1] = (idx or 0)..((#tbl%20==19) and ',\n   ' or ',')
+    end
+
+    local tp = TYPES.n2uint(#CODES.funcs+1)
+    tbl = [[
+#if defined(CEU_UNIT_ALL) || (CEU_UNIT == 0)
+static const tceu_lbl_f CEU_CODES_FUNCS[] = {
+    NULL,
+]]..table.concat(fs)..[[
+};
+static const ]]..tp..[[ CEU_LABELS_FUNCS[] = {
+    ]]..table.concat(tbl,' ')..[[
+
+};
+#endif /* CEU_UNIT == 0 */
+]]
+
+    local dispatch = [[
+{
+    ]]..tp..[[ __ceu_f = CEU_LABELS_FUNCS[_ceu_lbl];
+    if (__ceu_f != 0) {
+        return CEU_CODES_FUNCS[__ceu_f](_ceu_level, _ceu_cur, _ceu_nxt, _ceu_mem, _ceu_lbl, _ceu_trlK);
+    }
+}
+]]
+    return table.concat(protos)..'\n'..table.concat(funcs)..'\n'..tbl, dispatch
+end
+
+-- `--ceu-input-tables`:
+--  - each `code` (and the root) that does not need to scan all of its trails
+--    gets a row in `CEU_INPUTS_IDX` (`tceu_code_mem.inputs`, `0` for none)
+--  - each row has a column per input (`CEU_INPUT__ASYNC` first), with the
+--    offsets of its candidate trails in `CEU_INPUTS_TRAILS`
+--    (`idx[i]` to `idx[i+1]`)
+--  - candidates are the trails that await the input and the trails that
+--    propagate to `code` instances that may await it (transitively)
+--  - `ceu_bcast_mark` only visits the candidates of an input on whole `code`
+--    instances (`/dynamic` instances and `pause/if` scan all trails)
+function CODES.inputs_tables ()
+    if not CEU.opts.ceu_input_tables then
+        return '', '', 0
+    end
+
+    local root = AST.root.__codes_inputs or { trails={}, calls={}, reach={} }
+    local none = { trails={}, calls={}, reach={} }
+
+    -- code instantiated by "abs": its records, false if unknown (`/dynamic`)
+    local function IMPL (abs)
+        local mods = unpack(abs)
+        local impl = abs.base and abs.base.impl
+        if mods.dynamic or (not impl) then
+            return false
+        end
+        return impl.__codes_inputs or none
+    end
+
+    -- propagate inputs from callees to callers up to a fixed point
+    local changed = true
+    while changed do
+        changed = false
+        for _, t in ipairs(CODES.inputs) do
+            for _, call in ipairs(t.calls) do
+                local u = IMPL(call.abs)
+                if (not u) or u.all then
+                    if not t.all then
+                        t.all = true
+                        changed = true
+                    end
+                else
+                    for id in pairs(u.reach) do
+                        if not t.reach[id] then
+                            t.reach[id] = true
+                            changed = true
+                        end
+                    end
+                end
+            end
+        end
+    end
+
+    local cols = { 'CEU_INPUT__ASYNC', 'CEU_INPUT__THREAD', 'CEU_INPUT__WCLOCK' }
+    for _, dcl in ipairs(MEMS.exts) do
+        if (not dcl.__dcls_old) and dcl[1]=='input' then
+            cols[#cols+1] = dcl.id_
+        end
+    end
+
+    local trails = {}
+    local rows   = {}
+    local function ROW (t)
+        if t.full then
+            return 0
+        end
+        if t.row then
+            return t.row
+        end
+        local row = {}
+        for i, id in ipairs(cols) do
+            row[i] = #trails
+            local ts = {}
+            for _, trl in ipairs(t.trails[id] or {}) do
+                ts[trl] = true
+            end
+            for _, call in ipairs(t.calls) do
+                local u = IMPL(call.abs)
+                if (not u) or u.all or u.reach[id] then
+                    ts[call.trl] = true
+                end
+            end
+            local l = {}
+            for trl in pairs(ts) do
+                l[#l+1] = trl
+            end
+            table.sort(l)
+            for _, trl in ipairs(l) do
+                trails[#trails+1] = trl
+            end
+        end
+        row[#cols+1] = #trails
+        rows[#rows+1] = '    { '..table.concat(row,', ')..' },\n'
+        t.row = #rows
+        return t.row
+    end
+
+    local defines = { '#define CEU_INPUTS_ROOT '..ROW(root)..'\n' }
+    for _, abs in ipairs(CODES.abss) do
+        local u = IMPL(abs)
+        defines[#defines+1] = '#define CEU_INPUTS_'..abs.id_..' '..(u and ROW(u) or 0)..'\n'
+    end
+
+    trails[#trails+1] = 0   -- (never empty)
+    for i=20, #trails, 20 do
+        trails[i] = trails[i]..'\n   '
+    end
+    local n = #rows
+    if n == 0 then
+        rows[1] = '    { 0 },\n'  -- (never empty)
+    end
+
+    return table.concat(defines), [[
+typedef ]]..TYPES.n2uint(#trails)..[[ tceu_inputs_idx;
+static const tceu_ntrl CEU_INPUTS_TRAILS[] = {
+    ]]..table.concat(trails,', ')..[[
+
+};
+static const tceu_inputs_idx CEU_INPUTS_IDX[][]]..(#cols+1)..[[] = {
+]]..table.concat(rows)..[[
+};
+]], n
+end
+
 local labels do
-    labels = ''
+    labels = {}
     for _, lbl in ipairs(LABELS.list) do
-        labels = labels..lbl.id..',\n'
+        labels[#labels+1] = lbl.id..',\n'
+    end
+    labels = table.concat(labels)
+end
+
+-- `--ceu-features-hits`: source line of each label
+local labels_lines do
+    labels_lines = ''
+    if CEU.opts.ceu_features_hits then
+        local t = { '    "",\n' }     -- CEU_LABEL_NONE
+        for _, lbl in ipairs(LABELS.list) do
+            local ln = LNS[lbl.id]
+            ln = ln and (ln[1]..':'..ln[2]) or ''
+            t[#t+1] = '    "'..string.gsub(ln,'["\\]','\\%0')..'",\n'
+        end
+        labels_lines = [[
+static const char* CEU_LABELS_LINES[] = {
+]]..table.concat(t)..[[
+};
+]]
+    end
+end
+
+local trace_files do
+    trace_files = { '    __FILE__,\n' }
+    for i, file in ipairs(CEU.trace_files) do
+        trace_files[#trace_files+1] = '    "'..file..'",\n'
     end
+    trace_files = table.concat(trace_files)
+end
+
+local exts do
+    exts = {}
+    for i, ext in ipairs(CODES.exts) do
+        exts[i] = CODES.flat(ext)
+    end
+    exts = table.concat(exts,'\n')
 end
 
 local features do
@@ -1975,11 +2450,36 @@ local features do
             end
         end
     end
+    if CEU.opts.ceu_layout_aligned then
+        features = features .. '#define CEU_LAYOUT_ALIGNED\n'
+    end
+    if CEU.opts.ceu_input_tables then
+        features = features .. '#define CEU_INPUT_TABLES\n'
+    end
+    if CEU.opts.ceu_output_functions then
+        features = features .. '#define CEU_OUTPUT_FUNCTIONS\n'
+    end
+    if CEU.opts.ceu_async_budget > 1 then
+        features = features .. '#define CEU_ASYNC_BUDGET '..CEU.opts.ceu_async_budget..'\n'
+    end
+end
+
+local sizes do
+    sizes = {}
+    for i, id in ipairs(MEMS.sizes) do
+        sizes[i] = 'CEU_SIZE('..id..');\n'
+    end
+    sizes = table.concat(sizes)
 end
 
 -- CEU.C
 local c = PAK.files.ceu_c
+local funcs, dispatch = CODES.functions()
+local inputs_defines, inputs_tables, inputs_n = CODES.inputs_tables()
+
 local c = SUB(c, '=== CEU_TRAILS_N ===',         AST.root.trails_n)
+local c = SUB(c, '=== CEU_UNITS_N ===',          CEU.opts.ceu_units)
+local c = SUB(c, '=== CEU_LABELS_N ===',         #LABELS.list+1)
 local c = SUB(c, '=== CEU_FEATURES ===',         features)
 local c = SUB(c, '=== CEU_NATIVE_PRE ===',       CODES.native.pre)
 local c = SUB(c, '=== CEU_EXTS_ENUM_INPUT ===',  MEMS.exts.enum_input)
@@ -1990,24 +2490,83 @@ local c = SUB(c, '=== CEU_DATAS_HIERS ===',      MEMS.datas.hiers)
 local c = SUB(c, '=== CEU_DATAS_MEMS ===',       MEMS.datas.mems)
 local c = SUB(c, '=== CEU_DATAS_MEMS_CASTS ===', table.concat(MEMS.datas.casts,'\n'))
 local c = SUB(c, '=== CEU_EXTS_ENUM_OUTPUT ===', MEMS.exts.enum_output)
-local c = SUB(c, '=== CEU_CALLBACKS_OUTPUTS ===', table.concat(CODES.exts,'\n'))
+local c = SUB(c, '=== CEU_CALLBACKS_OUTPUTS ===', exts)
 local c = SUB(c, '=== CEU_TCEU_NTRL ===',        TYPES.n2uint(AST.root.trails_n))
 local c = SUB(c, '=== CEU_TCEU_NLBL ===',        TYPES.n2uint(#LABELS.list))
+local c = SUB(c, '=== CEU_TCEU_NINP ===',        TYPES.n2uint(inputs_n))
 local c = SUB(c, '=== CEU_CODES_MEMS ===',       MEMS.codes.mems)
+local c = SUB(c, '=== CEU_SIZES ===',            sizes)
 --local c = SUB(c, '=== CODES_ARGS ===',       MEMS.codes.args)
 local c = SUB(c, '=== CEU_EXTS_TYPES ===',       MEMS.exts.types)
+local c = SUB(c, '=== CEU_EXTS_SIZES_INPUT ===', MEMS.exts.sizes_input)
 local c = SUB(c, '=== CEU_EVTS_TYPES ===',       MEMS.evts.types)
 local c = SUB(c, '=== CEU_LABELS ===',           labels)
+local c = SUB(c, '=== CEU_LABELS_LINES ===',     labels_lines)
+local c = SUB(c, '=== CEU_TRACE_FILES ===',      trace_files)
+local c = SUB(c, '=== CEU_INPUTS_DEFINES ===',   inputs_defines)
+local c = SUB(c, '=== CEU_INPUTS_TABLES ===',    inputs_tables)
 local c = SUB(c, '=== CEU_NATIVE_POS ===',       CODES.native.pos)
-local c = SUB(c, '=== CEU_ISRS ===',             CODES.isrs)
-local c = SUB(c, '=== CEU_THREADS ===',          CODES.threads)
+local c = SUB(c, '=== CEU_ISRS ===',             CODES.flat(CODES.isrs))
+local c = SUB(c, '=== CEU_THREADS ===',          CODES.flat(CODES.threads))
 local c = SUB(c, '=== CEU_CODES_WRAPPERS ===',   MEMS.codes.wrappers)
-local c = SUB(c, '=== CEU_CODES ===',            AST.root.code)
+local c = SUB(c, '=== CEU_CODES_FUNCTIONS ===',  funcs)
+local c = SUB(c, '=== CEU_CODES ===',            CODES.flat(AST.root.code))
+local c = SUB(c, '=== CEU_CODES_DISPATCH ===',   dispatch)
+
+-- `--ceu-features-snapshot`: FNV-1a of the program (with all options)
+local hash = 0
+if CEU.opts.ceu_features_snapshot then
+    hash = 0x811C9DC5
+    for i=1, #c do
+        hash = ((hash ~ string.byte(c,i)) * 0x01000193) & 0xFFFFFFFF
+    end
+end
+local c = SUB(c, '=== CEU_SNAPSHOT_HASH ===',    string.format('0x%08X',hash))
+
+if CEU.opts.ceu_profile then
+    PROF.section('CEU_C', c)
+end
+
+CODES.c = '\n\n/* CEU_C */\n\n'..c     -- see `cache.lua`
+
+-- `--ceu-label-map`: one line per label, with tab-separated fields
+--      <n>\t<label>\t<file>:<line>\t<first>-<last>
+--  - lines of the C output (`--ceu-output`) from each `case` up to the next
+--    label or the end of the enclosing function
+if CEU.opts.ceu_label_map then
+    local cs = {}
+    local cur
+    local i = 0
+    for l in string.gmatch(CODES.c, '([^\n]*)\n') do
+        i = i + 1
+        local id = string.match(l, '^%s*case (CEU_LABEL_[%w_]+):;') or
+                   string.match(l, '^%s*(CEU_LABEL_[%w_]+):;')
+        if id then
+            cur = { i, i }
+            cs[id] = cur
+        elseif cur then
+            if l == '#undef CEU_TRACE' then
+                cur = nil
+            else
+                cur[2] = i
+            end
+        end
+    end
+
+    local f = ASR(io.open(CEU.opts.ceu_label_map,'w'))
+    for i, lbl in ipairs(LABELS.list) do
+        local ln = LNS[lbl.id]
+        ln = ln and (ln[1]..':'..ln[2]) or '-'
+        local c  = cs[lbl.id] and (cs[lbl.id][1]..'-'..cs[lbl.id][2]) or '-'
+        f:write(i..'\t'..lbl.id..'\t'..ln..'\t'..c..'\n')
+    end
+    f:close()
+end
 
 if CEU.opts.ceu_output == '-' then
-    print('\n\n/* CEU_C */\n\n'..c)
+    print(CODES.c)
 else
     local C = ASR(io.open(CEU.opts.ceu_output,'w'))
-    C:write('\n\n/* CEU_C */\n\n'..c)
+    C:write(CODES.c)
     C:close()
 end
@@ -93,11 +93,14 @@ F = {
     end,
 
     Pool = function (me)
-        local _,_,_,dim = unpack(me)
+        local _,_,_,dim,max = unpack(me)
         if dim == '[]' then
             return
         end
         ASR(dim.is_const, me, 'not implemented : dynamic limit for pools')
+        if max and max~='[]' then
+            ASR(max.is_const, me, 'not implemented : dynamic limit for pools')
+        end
     end,
 
     Loop_Num = 'Loop',
@@ -195,6 +195,17 @@ function DCLS.base (data)
     end
 end
 
+-- whether native "me" (`ID_nat`) cannot refer to the memory or state of the
+-- program: native code is opaque, so only native types and natives declared
+-- `pure`, `const`, or `plain` (e.g., not `_ceu_assert` or `{...}`)
+function DCLS.is_nat_pure (me)
+    if me.__par.tag == 'Type' then
+        return true
+    end
+    local mod = me.dcl and unpack(me.dcl)
+    return (mod=='pure' or mod=='const' or mod=='plain')
+end
+
 -- native declarations are allowed until `native/end`
 local native_end = false
 
@@ -428,13 +439,18 @@ DCLS.F = {
 
     Pool__PRE = 'Vec__PRE',
     Vec__PRE = function (me)
-        local is_alias,tp,id,dim = unpack(me)
+        local is_alias,tp,id,dim,max = unpack(me)
 
         if (dim == '[]') and (not is_alias) then
             ASR(CEU.opts.ceu_features_dynamic, me, 'dynamic allocation support is disabled')
         end
         if me.tag == 'Pool' then
             ASR(CEU.opts.ceu_features_pool, me, 'pool support is disabled')
+            if max then
+                -- pool[n->max]
+                ASR(not is_alias, me, 'invalid declaration : unexpected limit for pool alias')
+                ASR(CEU.opts.ceu_features_dynamic, me, 'dynamic allocation support is disabled')
+            end
         end
 
         if AST.par(me,'Data') or is_alias or TYPES.is_nat(TYPES.get(tp,1)) then
@@ -946,6 +962,12 @@ end
         local id = unpack(me)
         me.dcl = DCLS.asr(me, AST.par(me,'Block'), id, true, 'native identifier')
         EXPS.F.ID_nat(me)
+
+        -- `_CEU_PAR_Kk` uses `code/tight Kk` (see `tight_.lua`)
+        local code = string.match(id, '^_CEU_PAR_(.*)$')
+        if code then
+            DCLS.get(AST.par(me,'Block'), code, true)
+        end
     end,
 
     ID_ext = function (me)
@@ -18,8 +18,10 @@ end
 
 if TESTS then
     c = c .. [[
+#if !defined(CEU_UNIT) || (CEU_UNIT == 0)
 u32 _ceu_tests_bcasts_ = 0;
 u32 _ceu_tests_trails_visited_ = 0;
+#endif
 ]]
 end
 
@@ -32,9 +34,43 @@ end
 
 --env-main
 do
+    -- inlines the drivers of "env/main.c" (e.g., `#include "wclock.h"`), as
+    -- the output is compiled from elsewhere:
+    --  - only files next to the `--env-main` file that start with
+    --    `/* "env/main.c" with`, each at most once, without recursion
+    --  - other includes are kept as they are
+    local MARK = '/* "env/main.c" with'
+
+    local function read (path)
+        local f = io.open(path)
+        if not f then
+            return nil
+        end
+        local src = f:read'*a'
+        f:close()
+        return src
+    end
+
     if CEU.opts.env_main then
-        local f = ASR(io.open(CEU.opts.env_main))
-        c = c..'\n\n/* ENV_MAIN */\n\n'..f:read'*a'
+        local f    = ASR(io.open(CEU.opts.env_main))
+        local dir  = string.match(CEU.opts.env_main, '^(.*/)') or ''
+        local seen = {}
+        local src  = string.gsub(f:read'*a',
+            '\n#include "([^"\n]*)"[^\n]*',
+            function (file)
+                local drv = read(dir..file)
+                if not (drv and string.sub(drv,1,#MARK)==MARK) then
+                    return nil
+                elseif seen[file] then
+                    return '\n/* '..file..' (already included) */'
+                end
+                seen[file] = true
+                return '\n/* '..file..' */\n'..drv
+            end)
+        c = c..'\n\n/* ENV_MAIN */\n\n'..
+                '#if defined(CEU_UNIT_ALL) || (CEU_UNIT == 0)\n'..
+                src..
+                '\n#endif /* CEU_UNIT == 0 */\n'
         f:close()
     end
 end
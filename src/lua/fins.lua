@@ -35,9 +35,9 @@ F = {
 
     Vec_Init__PRE = function (me)
         local vec = unpack(me)
-        local _,_,_,dim = unpack(vec.info.dcl)
-        if dim.is_const then
-            return
+        local _,_,_,dim,max = unpack(vec.info.dcl)
+        if dim.is_const and (not max) then
+            return      -- (pool[n->max] frees its overflow)
         end
 
         if me.__fins_ok then
@@ -1,9 +1,129 @@
 local node = AST.node
 
+-- Inlining of `code/await` abstractions (`--ceu-inline-budget=N`):
+--  - replaces `await Ff(...)` and `spawn Ff(...)` (without a pool or an
+--    alias) with a copy of the body of `Ff`
+--  - each inlined call copies the body of the abstraction, which saves its
+--    `tceu_code_mem`, the trail that propagates events to it, and one level
+--    of broadcast recursion
+--  - cost: AST nodes of the body times the number of extra copies
+--  - inlines abstractions with cost up to `N` (`0` only inlines abstractions
+--    used once, `-1` disables inlining)
+
+INLINES = {
+    list = {},      -- { {id=,uses=,nodes=}, ... } (see `prof.lua`)
+}
+
+function INLINES.nodes (me)
+    local n = 1
+    for _, sub in ipairs(me) do
+        if AST.is_node(sub) then
+            n = n + INLINES.nodes(sub)
+        end
+    end
+    return n
+end
+
+-- whether "base" reaches itself through the abstractions it invokes
+local function is_recursive (base, cur, visited)
+    cur = cur or base
+    visited = visited or {}
+    if visited[cur] then
+        return false
+    end
+    visited[cur] = true
+    if not cur.impl then
+        return false
+    end
+    local function f (me)
+        if me.tag == 'Abs_Cons' then
+            local _, ID_abs = unpack(me)
+            local dcl = ID_abs.dcl
+            if dcl and dcl.tag=='Code' then
+                if dcl.base==base or is_recursive(base, dcl.base, visited) then
+                    return true
+                end
+            end
+        end
+        for _, sub in ipairs(me) do
+            if AST.is_node(sub) and f(sub) then
+                return true
+            end
+        end
+        return false
+    end
+    return f(cur.impl.__adjs_2)
+end
+
+-- whether the body of "impl" can be copied into the caller:
+--  - no public fields, `outer`, or `throw` (they refer to the abstraction)
+--  - no native code that may refer to its memory (e.g., `_ceu_mem`), see
+--    `DCLS.is_nat_pure`
+--  - no `event&` parameters (duplicated in the caller on multiple copies)
+local function is_plain (impl)
+    local mid = AST.get(impl.__adjs_2,'Block', 1,'Stmts', 1,'Stmts')
+    if mid and #mid>0 then
+        return false
+    end
+    for _, dcl in ipairs(impl.__adjs_1.dcls) do
+        if dcl.tag == 'Evt' then
+            return false
+        end
+    end
+    local function f (me)
+        if me.tag=='Outer' or me.tag=='Throw' or
+           me.tag=='Nat_Stmt' or me.tag=='Nat_Block'
+        then
+            return false
+        elseif me.tag=='ID_nat' and (not DCLS.is_nat_pure(me)) then
+            return false
+        end
+        for _, sub in ipairs(me) do
+            if AST.is_node(sub) and (not f(sub)) then
+                return false
+            end
+        end
+        return true
+    end
+    return f(impl.__adjs_2)
+end
+
+-- decided once for all declarations of the same abstraction
+function INLINES.should (dcl)
+    local base = dcl.base
+    if base.__inlines_should ~= nil then
+        return base.__inlines_should
+    end
+
+    local impl = base.impl
+    local mods, _, throws = unpack(base)
+    local tp = AST.get(base,'Code', 4,'Block', 1,'Stmts', 1,'Code_Ret', 1,'', 2,'Type')
+    local ok = (CEU.opts.ceu_inline_budget >= 0) and
+               mods.await and (not mods.dynamic) and (not mods.recursive) and
+               (not throws) and tp and    -- no `NEVER`
+               (not (base.__dcls_depth or base.__dcls_noinline or base.__inlines_no))
+    if ok and impl then
+        ok = (not (impl.__dcls_depth or impl.__dcls_noinline)) and
+             is_plain(impl) and (not is_recursive(base))
+    end
+
+    local uses  = base.__dcls_uses or 0
+    local nodes = impl and INLINES.nodes(impl.__adjs_2) or 0
+    if ok then
+        -- unused abstractions are kept to be checked by the next passes
+        ok = (uses > 0) and (nodes*(uses-1) <= CEU.opts.ceu_inline_budget)
+    end
+    if ok then
+        INLINES.list[#INLINES.list+1] = { id=base.id, uses=uses, nodes=nodes }
+    end
+
+    base.__inlines_should = ok
+    return ok
+end
+
 F = {
     Code__PRE = function (me)
-        local mods = unpack(me)
-        me.__inlines_should = (not me.__dcls_depth) and (not me.__dcls_noinline) and mods.await and (me.base.__dcls_uses or 0)<=1
+        me.__inlines_should = INLINES.should(me)
         if me.__inlines_should then
             return node('Nothing', me.ln)
         end
@@ -33,7 +153,7 @@ F = {
     Abs_Await__PRE = function (me)
         local _, Abs_Cons = unpack(me)
         local _, ID_abs, Abslist = unpack(Abs_Cons)
-        if ID_abs.dcl.__inlines_should then
+        if INLINES.should(ID_abs.dcl) then
             local do_ = node('Do', me.ln, true, false)
             AST.insert(do_, #do_+1, AST.copy(ID_abs.dcl.base.impl.__adjs_2))
 
@@ -115,6 +235,31 @@ F = {
     end,
 }
 
+-- only `await` and `spawn` (without pools or aliases) are inlined: the other
+-- uses require the abstraction
+local function uses (me)
+    if me.tag == 'Abs_Cons' then
+        local _, ID_abs = unpack(me)
+        local dcl = ID_abs.dcl
+        if dcl and dcl.tag=='Code' then
+            local par = me.__par
+            if not (par.tag=='Abs_Await' or
+                    par.tag=='Abs_Spawn' and par.__par.tag~='Set_Abs_Spawn')
+            then
+                dcl.base.__inlines_no = true
+            end
+        end
+    end
+    for _, sub in ipairs(me) do
+        if AST.is_node(sub) then
+            uses(sub)
+        end
+    end
+end
+if CEU.opts.ceu_inline_budget >= 0 then
+    uses(AST.root)
+end
+
 __inlines = true    -- disables <<declaration of "x" hides previous declaration>>
---AST.visit(F)
+AST.visit(F)
 __inlines = false
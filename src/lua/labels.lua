@@ -3,10 +3,11 @@ LABELS = {
 }
 
 local function new (lbl)
+    lbl.code = AST.iter'Code'()     -- enclosing `code` (see `--ceu-units`)
     if lbl[2] then
         lbl.id = 'CEU_LABEL_'..lbl[1]
     else
-        local Code = AST.iter'Code'()
+        local Code = lbl.code
         Code = (Code and Code.id..'_') or ''
         lbl.id = 'CEU_LABEL_'..Code..lbl[1]..'_'..(#LABELS.list+1)
     end
@@ -7,6 +7,20 @@ local patt
 
 CEU.i2l = {}
 
+-- `--ceu-features-trace`: files of trace sites (`CEU_TRACE_FILES`)
+--  - index `0` is the C output itself (see `--ceu-line-directives`)
+CEU.trace_files = {}
+function CEU.trace_file (file)
+    local n = CEU.trace_files[file]
+    if not n then
+        n = #CEU.trace_files + 1
+        ASR(n < 4096, 'too many files for `--ceu-features-trace` (4095)')
+        CEU.trace_files[n]    = file
+        CEU.trace_files[file] = n
+    end
+    return n
+end
+
 local line = m.Cmt('\n',
     function (s,i)
         for i=#CEU.i2l, i do
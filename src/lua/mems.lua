@@ -5,6 +5,7 @@ MEMS = {
         enum_input  = '',
         enum_output = '',
         defines_input_output = '',
+        sizes_input = '',
     },
     evts = {
         types = '',
@@ -29,6 +30,7 @@ MEMS = {
         bases = {},
         casts = {},     -- see code.lua
     },
+    sizes = {},         -- types reported with `CEU_SIZES` (see `ceu.c`)
     opts = {
         -- avoids duplications
         --[TYPES.tostring(tp)] = true,
@@ -65,6 +67,7 @@ typedef struct tceu_code_mem_ROOT {
 } tceu_code_mem_ROOT;
 ]]..'\n'
         MEMS.codes[#MEMS.codes+1] = me.mems
+        MEMS.sizes[#MEMS.sizes+1] = 'tceu_code_mem_ROOT'
     end,
 
     ---------------------------------------------------------------------------
@@ -98,6 +101,7 @@ typedef struct tceu_code_mem_]]..me.id_..[[ {
     };
 } tceu_code_mem_]]..me.id_..[[;
 ]]
+        MEMS.sizes[#MEMS.sizes+1] = 'tceu_code_mem_'..me.id_
     end,
 
     Code = function (me)
@@ -195,7 +199,7 @@ CEU_CODE_]]..me.id_..[[ (tceu_code_mem_]]..me.id_..[[ mem_,
     mem_._mem.up_mem = up_mem;
     mem_._mem.depth  = ]]..me.depth..[[;
 #ifdef CEU_FEATURES_TRACE
-    mem_._mem.trace = trace;
+    mem_._mem.trace = trace.site;
 #endif
 #ifdef CEU_FEATURES_LUA
     mem_._mem.lua = lua;
@@ -219,6 +223,29 @@ CEU_CODE_]]..me.id_..[[ (tceu_code_mem_]]..me.id_..[[ mem_,
             me.mems.wrapper = me.mems.wrapper..[[
 }
 ]]
+            if me.__tight_par then
+                -- kernel of `include/par.ceu` (see `tight_.lua`)
+                local pars = me.__adjs_1.dcls
+                me.mems.wrapper = me.mems.wrapper .. [[
+static void CEU_PAR_]]..me.id_..[[ (void* buf, usize i0, usize i1, void* arg)
+{
+    usize i;
+    for (i=i0; i<i1; i++) {
+        tceu_code_mem_]]..me.id_..[[ mem;
+        mem.]]..pars[1].id_..[[ = ((]]..TYPES.toc(pars[1][2])..[[)buf) + i;
+        mem.]]..pars[2].id_..[[ = (]]..TYPES.toc(pars[2][2])..[[)arg;
+        CEU_CODE_]]..me.id_..[[(mem, NULL
+#ifdef CEU_FEATURES_TRACE
+                      , CEU_TRACE_null
+#endif
+#ifdef CEU_FEATURES_LUA
+                      , NULL
+#endif
+                        );
+    }
+}
+]]
+            end
         else
             me.mems.wrapper = me.mems.wrapper .. [[
 static tceu_nlbl CEU_CODE_]]..me.id_..[[_to_lbl (tceu_code_mem_]]..me.id_..[[* mem)
@@ -265,6 +292,7 @@ assert(me.hier)
 ]]..'\n'
 
         MEMS.datas.mems = MEMS.datas.mems..me.mems.mem
+        MEMS.sizes[#MEMS.sizes+1] = 'tceu_data_'..me.id_
 
         if me.hier and (not me.hier.up) then
             MEMS.datas.bases[#MEMS.datas.bases+1] = me
@@ -350,6 +378,38 @@ static ]]..cc..'* CEU_OPTION_'..cc..'_ ('..cc..[[* opt
 
     ---------------------------------------------------------------------------
 
+    -- estimated alignment of the C declaration of "dcl"
+    -- (native and abstraction types are assumed to have pointers)
+    __align = function (dcl)
+        if dcl.tag ~= 'Var' then
+            return 8    -- tceu_evt, tceu_vector, tceu_pool_pak, ...
+        end
+        local alias, tp = unpack(dcl)
+        if alias or TYPES.check(tp,'&&') then
+            return 8
+        end
+        if TYPES.check(tp,'?') then
+            tp = TYPES.pop(tp,'?')
+            if TYPES.check(tp,'&&') then
+                return 8
+            end
+        end
+        local ID = unpack(tp)
+        if ID.tag ~= 'ID_prim' then
+            return 8
+        end
+        local id = ID[1]
+        if id=='bool' or id=='byte' or id=='u8' or id=='s8' then
+            return 1
+        elseif id=='u16' or id=='s16' then
+            return 2
+        elseif id=='u32' or id=='s32' or id=='int' or id=='uint' or id=='r32' then
+            return 4
+        else
+            return 8
+        end
+    end,
+
     __dcl2c = function (dcl)
         if dcl.tag == 'Var' then
             local alias, tp = unpack(dcl)
@@ -411,7 +471,7 @@ tceu_pool_pak]]..ptr..' '..dcl.id_..[[;
     end,
 
     Block__PRE = function (me)
-        local mem = {}
+        local ents = {}
 
         local code = AST.par(me, 'Code')
         local toplevel = ( AST.get(me,1,'Data') or
@@ -419,6 +479,7 @@ tceu_pool_pak]]..ptr..' '..dcl.id_..[[;
 
         for _, dcl in ipairs(me.dcls) do
 if dcl.tag ~= 'Prim' then
+            local mem = {}
             local alias, Type = unpack(dcl)
 
             if dcl.ln then
@@ -519,8 +580,36 @@ if dcl.tag ~= 'Prim' then
                 end
                 dcl.id_ = string.upper('CEU_'..inout..'_'..id)
             end
+
+            ents[#ents+1] = { str=table.concat(mem), align=F.__align(dcl) }
 end
         end
+
+        -- `--ceu-layout-aligned`: largest alignments first, minimizing padding
+        --  - not for data hierarchies, in which the fields of the base must be
+        --    a prefix of the fields of its extensions (casts)
+        --  - not for the parameters of dynamic codes, which share the memory
+        --    of all implementations
+        if CEU.opts.ceu_layout_aligned then
+            local data = AST.par(me,'Data')
+            if not ((data and data.hier) or (toplevel and code and code[1].dynamic)) then
+                for i, ent in ipairs(ents) do
+                    ent.i = i
+                end
+                table.sort(ents, function (e1, e2)
+                    if e1.align == e2.align then
+                        return e1.i < e2.i      -- stable
+                    else
+                        return e1.align > e2.align
+                    end
+                end)
+            end
+        end
+
+        local mem = {}
+        for i, ent in ipairs(ents) do
+            mem[i] = ent.str
+        end
         if AST.par(me,'Data') then
             CUR().mem = CUR().mem..table.concat(mem)
         else
@@ -659,6 +748,7 @@ if not dcl.__dcls_old then
     -- enum
     if inout == 'input' then
         MEMS.exts.enum_input  = MEMS.exts.enum_input..dcl.id_..',\n'
+        MEMS.exts.sizes_input = MEMS.exts.sizes_input..'['..dcl.id_..'] = sizeof(tceu_input_'..dcl.id..'),\n'
     else
         MEMS.exts.enum_output = MEMS.exts.enum_output..dcl.id_..',\n'
     end
@@ -681,6 +771,10 @@ typedef struct tceu_]]..inout..[[_mem_]]..dcl.id..[[ {
     ]]..AST.par(dcl,'Ext_impl').mems.mem..[[
 } tceu_]]..inout..[[_mem_]]..dcl.id..[[;
 ]]
+    elseif inout=='output' and CEU.opts.ceu_output_functions then
+        -- `--ceu-output-functions`: defined by the environment
+        local ps = (#Typelist==0 and 'void') or ('tceu_output_'..dcl.id..'* ps')
+        mem = mem..'int ceu_output_'..dcl.id..' ('..ps..');\n'
     end
 
     MEMS.exts.types = MEMS.exts.types..mem
@@ -789,13 +883,13 @@ enum {
     ]]..t.ids..[[
 };
 
-tceu_ndata CEU_DATA_SUPERS_]]..base.id_..[[ [] = {
+static tceu_ndata CEU_DATA_SUPERS_]]..base.id_..[[ [] = {
     ]]..t.supers..[[
 };
 ]]
     if t.nums ~= '' then
         MEMS.datas.hiers = MEMS.datas.hiers .. [[
-tceu_ndata CEU_DATA_NUMS_]]..base.id_..[[ [] = {
+static tceu_ndata CEU_DATA_NUMS_]]..base.id_..[[ [] = {
     ]]..t.nums..[[
 };
 ]]
@@ -34,6 +34,8 @@ end
 subst('optparse.lua', true)
 subst 'dbg.lua'
 subst 'cmd.lua'
+subst 'prof.lua'
+subst 'cache.lua'
 subst 'pre.lua'
 subst 'lines.lua'
 subst 'parser.lua'
@@ -546,7 +546,7 @@ GG = { [1] = x * V'_Stmts' * V'Y' * (P(-1) + E('end of file'))
     , _Var_set  = K'var'    * OPT(V'__ALS') * OPT(V'__Dim_Ring')
                             * Ct((Cg(K'/dynamic','dynamic') + Cg(K'/nohold','nohold'))^-1)
                                                      * V'Type'             * V'__var_set'
-    , _Pool_set = K'pool'   * OPT(CKK'&') * V'__Dim' * V'Type'             * V'__var_set'
+    , _Pool_set = K'pool'   * OPT(CKK'&') * V'__Dim_Pool' * V'Type'        * V'__var_set'
     , _Evt_set  = K'event'  * OPT(CKK'&') * (PARENS(V'_Typelist')+V'Type') * V'__var_set'
 
     , Ext = CK'input'  * (PARENS(V'_Typelist')     + V'Type')             * V'__ID_ext'
@@ -710,6 +710,8 @@ GG = { [1] = x * V'_Stmts' * V'Y' * (P(-1) + E('end of file'))
 
     , __Dim      = KK'[' * (V'__Exp'+Cc('[]')) * KK']'
     , __Dim_Ring = KK'[' * (V'__Exp'+Cc('[]')) * (OPT(CK'*')+Cc(false)) * KK']'
+    , __Dim_Pool = KK'[' * ( V'__Exp' * (KK'->'*(V'__Exp'+Cc('[]')) + Cc(false))
+                           + Cc('[]') * Cc(false) ) * KK']'
 
 -- LISTS
 
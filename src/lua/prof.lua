@@ -0,0 +1,80 @@
+-- Compiler profiling (`--ceu-profile=true`):
+--  - time, Lua memory, and AST nodes after each phase
+--  - size of each section of the generated C
+--  - inlined abstractions, trails, and labels
+-- The report goes to `stderr` as a Lua table, which can be loaded back with
+-- `load('return '..report)` to compare compiler versions.
+-- (Times are process CPU times from `os.clock`: Lua has no portable
+-- sub-second wall clock.)
+
+PROF = {
+    phases   = {},
+    sections = {},
+    clock    = os.clock(),
+}
+
+local function nodes (me)
+    local n = 1
+    for _, sub in ipairs(me) do
+        if AST.is_node(sub) then
+            n = n + nodes(sub)
+        end
+    end
+    return n
+end
+
+function PROF.phase (id)
+    if not CEU.opts.ceu_profile then
+        return
+    end
+    local now = os.clock()
+    PROF.phases[#PROF.phases+1] = {
+        id    = id,
+        secs  = now - PROF.clock,
+        kb    = collectgarbage('count'),
+        nodes = (AST and AST.root and nodes(AST.root)) or 0,
+    }
+    PROF.clock = os.clock()     -- do not account for `nodes()`
+end
+
+function PROF.section (id, str)
+    if not CEU.opts.ceu_profile then
+        return
+    end
+    PROF.sections[#PROF.sections+1] = { id=id, bytes=#tostring(str) }
+end
+
+function PROF.report ()
+    if not CEU.opts.ceu_profile then
+        return
+    end
+    local t = {}
+    local tot = 0
+    t[#t+1] = 'CEU_PROFILE = {\n    phases = {\n'
+    for _, p in ipairs(PROF.phases) do
+        tot = tot + p.secs
+        t[#t+1] = string.format(
+            '        { id=%-10s secs=%.4f, kb=%d, nodes=%d },\n',
+            string.format('%q,',p.id), p.secs, math.floor(p.kb), p.nodes)
+    end
+    t[#t+1] = '    },\n    sections = {\n'
+    for _, s in ipairs(PROF.sections) do
+        t[#t+1] = string.format('        { id=%-40s bytes=%d },\n',
+                                string.format('%q,',s.id), s.bytes)
+    end
+    t[#t+1] = '    },\n    inlines = {\n'
+    for _, v in ipairs(INLINES and INLINES.list or {}) do
+        t[#t+1] = string.format('        { id=%-20s uses=%d, nodes=%d },\n',
+                                string.format('%q,',v.id), v.uses, v.nodes)
+    end
+    t[#t+1] = '    },\n'
+    if AST and AST.root and AST.root.trails_n then
+        t[#t+1] = string.format('    trails = %d,\n', AST.root.trails_n)
+    end
+    if LABELS then
+        t[#t+1] = string.format('    labels = %d,\n', #LABELS.list)
+    end
+    t[#t+1] = string.format('    secs = %.4f,\n', tot)
+    t[#t+1] = '}\n'
+    io.stderr:write(table.concat(t))
+end
@@ -1,5 +1,140 @@
 PROPS_ = {}
 
+-- `--ceu-units`: "native" blocks are compiled into every unit, so each unit
+-- has its own copy of what they define:
+--  - functions must be `static` (same code in each unit)
+--  - variables must be `static const` (same value in each unit), or declared
+--    `extern` and defined inside `#if ... CEU_UNIT == 0 ... #endif` (a single
+--    definition, shared by all units)
+--  - `static` variables inside functions are also per unit
+--  - returns the identifier and kind ('function' or 'variable') of the first
+--    definition that breaks these rules
+function PROPS_.nat_global (code)
+    code = string.gsub(code, '/%*.-%*/', ' ')
+    code = string.gsub(code, '//[^\n]*', ' ')
+    code = string.gsub(code, '\\.', '')          -- escapes, line continuations
+    code = string.gsub(code, '"[^"]*"', '""')
+    code = string.gsub(code, "'[^']*'", "''")
+
+    -- skip definitions for unit 0 and other directives
+    do
+        local lines = {}
+        local skip = 0
+        for l in string.gmatch(code..'\n', '([^\n]*)\n') do
+            local dir = string.match(l, '^%s*#+%s*(%a+)')
+            if skip > 0 then
+                if dir=='if' or dir=='ifdef' or dir=='ifndef' then
+                    skip = skip + 1
+                elseif dir == 'endif' then
+                    skip = skip - 1
+                end
+                l = ''
+            elseif dir=='if' and string.match(l,'CEU_UNIT%s*%)?%s*==%s*0') then
+                skip = 1
+                l = ''
+            elseif dir then
+                l = ''
+            end
+            lines[#lines+1] = l
+        end
+        code = table.concat(lines, '\n')
+    end
+
+    local function has (chunk, word)
+        return string.match(chunk, '%f[%w_]'..word..'%f[^%w_]')
+    end
+
+    -- "const" applies to the object, not only to what it points to
+    local function is_const (lhs)
+        lhs = string.gsub(lhs, '%b[]', '')
+        return has(string.match(lhs,'^.*%*(.-)$') or lhs, 'const')
+    end
+
+    local function check (chunk, is_func)
+        if has(chunk,'typedef') then
+            return nil
+        end
+        if is_func then
+            if has(chunk,'static') then
+                return nil
+            end
+            return string.match(chunk, '([%a_][%w_]*)%s*%b()%s*$'), 'function'
+        end
+        chunk = string.match(chunk, '^%s*(.-)%s*$')
+        local lhs = string.match(chunk, '^([^=]*)=')
+        if not lhs then
+            if chunk=='' or string.sub(chunk,-1)=='}' then
+                return nil                          -- struct S {...};
+            end
+            lhs = chunk
+        end
+        lhs = string.match(lhs, '^(.-)%s*$')
+        local ptr = string.match(lhs, '%(%s*%*%s*([%a_][%w_]*)')
+        if (not ptr) and string.sub(lhs,-1)==')' then
+            return nil                              -- prototype
+        elseif has(lhs,'extern') and lhs==chunk then
+            return nil                              -- declaration
+        elseif has(lhs,'static') and is_const(lhs) then
+            return nil
+        end
+        local id = ptr or string.match(string.gsub(lhs,'%b[]',''), '([%a_][%w_]*)%s*$')
+        return id or chunk, 'variable'
+    end
+
+    local depth = 0
+    local chunk = {}
+    local func = false      -- inside the body of a function
+    for c in string.gmatch(code, '.') do
+        if c == '{' then
+            if depth == 0 then
+                local head = table.concat(chunk)
+                if string.match(head, '%)%s*$') then
+                    local id, kind = check(head, true)
+                    if id then
+                        return id, kind
+                    end
+                    func = true
+                    chunk = {}
+                else
+                    chunk[#chunk+1] = '{'
+                end
+            elseif func then
+                chunk = {}
+            end
+            depth = depth + 1
+        elseif c == '}' then
+            depth = depth - 1
+            if depth == 0 then
+                if func then
+                    func = false
+                    chunk = {}
+                else
+                    chunk[#chunk+1] = '}'
+                end
+            elseif func then
+                chunk = {}
+            end
+        elseif depth==0 or func then
+            if c == ';' then
+                local str = table.concat(chunk)
+                if depth == 0 then
+                    local id, kind = check(str, false)
+                    if id then
+                        return id, kind
+                    end
+                elseif has(str,'static') and (not is_const(string.match(str,'^([^=]*)'))) then
+                    return string.match(string.gsub(string.match(str,'^([^=]*)'),'%b[]',''),
+                                        '([%a_][%w_]*)%s*$'), 'variable'
+                end
+                chunk = {}
+            else
+                chunk[#chunk+1] = c
+            end
+        end
+    end
+    return nil
+end
+
 local sync = {
     Await_Forever=true, Await_Ext=true, Await_Int=true, Await_Wclock=true,
     Abs_Spawn=true,
@@ -263,7 +398,19 @@ PROPS_.F = {
 
     Pause_If = function (me)
         ASR(CEU.opts.ceu_features_pause, me, '`pause/if` support is disabled')
-    end
+    end,
+
+    Nat_Block = function (me)
+        if CEU.opts.ceu_units > 0 then
+            local _, code = unpack(me)
+            local id, kind = PROPS_.nat_global(code)
+            ASR(not id, me,
+                'invalid `native` block : unexpected global definition "'..tostring(id)..'" : '..
+                (kind=='function' and 'expected `static`' or
+                 'expected `static const`, or `extern` with the definition under `CEU_UNIT == 0`')..
+                ' (see `--ceu-units`)')
+        end
+    end,
 }
 
 AST.visit(PROPS_.F)
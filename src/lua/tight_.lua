@@ -174,3 +174,83 @@ G = {
 }
 
 AST.visit(G)
+
+-------------------------------------------------------------------------------
+-- `include/par.ceu`: the native `_CEU_PAR_Kk` is the kernel generated from
+-- `code/tight Kk (var T&& x, var U&& arg) -> none` (see `mems.lua`), which
+-- runs in worker threads, once for each element of a vector of `T`:
+--  - no `outer`, emits, `throw`, Lua, nor natives that are not pure (see
+--    `DCLS.is_nat_pure`), which would touch the program concurrently
+--  - only calls `code/tight` with the same restrictions
+--  - `Par_For` only takes these kernels
+
+local function par_body (code, visited)
+    if visited[code] then
+        return
+    end
+    visited[code] = true
+
+    local mods = unpack(code)
+    ASR(mods.tight and (not mods.dynamic) and code.is_impl, code,
+        'invalid `Par_For` kernel : expected `code/tight` implementation')
+
+    local function f (me)
+        local tag = me.tag
+        local no = (tag=='Outer' and 'outer') or (tag=='Throw' and 'throw') or
+                   ((tag=='Nat_Stmt' or tag=='Nat_Block') and 'native block') or
+                   (string.match(tag,'^Emit_') and 'emit') or
+                   (string.match(tag,'^_?Lua') and 'lua')
+        if no then
+            ASR(false, me, 'invalid `Par_For` kernel : unexpected `'..no..'`')
+        elseif tag=='ID_nat' and (not DCLS.is_nat_pure(me)) then
+            ASR(false, me, 'invalid `Par_For` kernel : expected `pure` native')
+        elseif tag == 'Abs_Call' then
+            local dcl = AST.asr(me,'', 2,'Abs_Cons', 2,'ID_abs').dcl
+            par_body((dcl.base and dcl.base.impl) or dcl, visited)
+        end
+        for _, sub in ipairs(me) do
+            if AST.is_node(sub) then
+                f(sub)
+            end
+        end
+    end
+    f(code[4])
+end
+
+local function par_kernel (me, id)
+    local dcl = DCLS.get(AST.par(me,'Block'), id, true)
+    ASR(dcl and dcl.tag=='Code', me, 'invalid `Par_For` kernel : unknown `code` "'..id..'"')
+    local code = (dcl.base and dcl.base.impl) or dcl
+    par_body(code, {})
+
+    local pars = code.__adjs_1.dcls
+    local ret = AST.get(code,'Code', 4,'Block', 1,'Stmts', 1,'Code_Ret', 1,'', 2,'Type')
+    ASR(#pars==2 and pars[1].tag=='Var' and TYPES.check(pars[1][2],'&&') and
+                     pars[2].tag=='Var' and TYPES.check(pars[2][2],'&&') and
+        ret and TYPES.check(ret,'none'), code,
+        'invalid `Par_For` kernel : expected `(var T&& x, var U&& arg) -> none`')
+    code.__tight_par = true
+    return code
+end
+
+H = {
+    ID_nat = function (me)
+        local id = string.match(me[1], '^_CEU_PAR_(.*)$')
+        if id then
+            me.__tight_par = par_kernel(me, id)
+        end
+    end,
+
+    Abs_Cons__POS = function (me)
+        local _, ID_abs, Abslist = unpack(me)
+        local _, id = unpack(ID_abs.dcl)
+        if ID_abs.dcl.tag=='Code' and id=='Par_For' then
+            local f = Abslist[2]
+            f = (f.tag=='Loc' and f[1]) or f
+            ASR(f.tag=='ID_nat' and f.__tight_par, me,
+                'invalid `Par_For` : expected kernel `_CEU_PAR_<id>`')
+        end
+    end,
+}
+
+AST.visit(H)
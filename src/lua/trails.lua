@@ -1,5 +1,16 @@
 TRAILS = {}
 
+-- The CLEAR continuation of a `loop` is only used to abort its body on
+-- `break`/`continue` and to resume `async` loops (see `codes.lua`).
+-- Other loops (e.g., `every`) reuse the slot for the body.
+function TRAILS.has_clear (me)
+    local Code = AST.par(me, 'Code')
+    if Code and Code[1].tight then
+        return false
+    end
+    return me.has_break or me.has_continue or AST.par(me,'Async')
+end
+
 local function MAX (v1, v2)
     return (v1 > v2) and v1 or v2
 end
@@ -30,10 +41,9 @@ TRAILS.F = {
     end,
     Loop = function (me)
         local _, body = unpack(me)
-        me.trails_n = body.trails_n + 1 -- CLEAR continuation
-        local Code = AST.par(me, 'Code')
-        if Code and Code[1].tight then
-            me.trails_n = me.trails_n - 1
+        me.trails_n = body.trails_n
+        if TRAILS.has_clear(me) then
+            me.trails_n = me.trails_n + 1 -- CLEAR continuation
         end
     end,
 
@@ -104,7 +114,9 @@ G = {
     Loop__PRE = function (me)
         local _, body = unpack(me)
         body.trails = { unpack(me.trails) }
-        body.trails[1] = body.trails[1] + 1
+        if TRAILS.has_clear(me) then
+            body.trails[1] = body.trails[1] + 1
+        end
     end,
 
     Pause_If__PRE = function (me)
@@ -132,8 +144,8 @@ G = {
     -- invert pool/finalize b/c finalize frees pool before last iteration
     __ok = false,
     Pool = function (me)
-        local is_alias,_,_,dim = unpack(me)
-        if (not dim.is_const) and (not is_alias) then
+        local is_alias,_,_,dim,max = unpack(me)
+        if (not (dim.is_const and (not max))) and (not is_alias) then
             TRAILS.F.__ok = true
             me.trails[1] = me.trails[1] + 1 + 1 -- (+1 CLEAR continuation)
             me.trails[2] = me.trails[2] + 1 + 1 -- (+1 CLEAR continuation)
@@ -151,3 +163,65 @@ G = {
 
 AST.visit(G)
 
+
+-------------------------------------------------------------------------------
+
+-- `has_fins`: the trails of the node may hold finalizers (including vector
+-- and pool finalizations and thread cancellations) or nested abstractions,
+-- which a CLEAR has to visit (otherwise, see `CLEAR` in "codes.lua").
+-- The `Code_Finalize` of a `code` only counts as `'code'`: codes without
+-- others have `no_fins` and their pools are released in one step (see
+-- `ceu_code_mem_dyn_release`).
+
+H = {
+    Node = function (me)
+        for _, sub in ipairs(me) do
+            -- (the trails of a `code` are in its own memory)
+            if AST.is_node(sub) and sub.tag~='Code' and sub.has_fins and me.has_fins~=true then
+                me.has_fins = sub.has_fins
+            end
+        end
+    end,
+
+    Finalize_Case = function (me)
+        local case, blk = unpack(me)
+        if case == 'CEU_INPUT__FINALIZE' then
+            if AST.get(blk,'Block', 1,'Stmts', 1,'Code_Finalize') then
+                me.has_fins = 'code'
+            else
+                me.has_fins = true
+            end
+        end
+    end,
+
+    Loop_Pool    = function (me) me.has_fins = true end,   -- FINALIZE
+    Async_Thread = function (me) me.has_fins = true end,   -- FINALIZE
+    Abs_Await    = function (me) me.has_fins = true end,   -- PROPAGATE_CODE
+    Abs_Spawn    = function (me) me.has_fins = true end,   -- PROPAGATE_CODE
+    Pool = function (me)                                    -- PROPAGATE_POOL
+        local is_alias = unpack(me)
+        if not is_alias then
+            me.has_fins = true
+        end
+    end,
+
+    Code__POS = function (me)
+        if me.is_dyn_base or (not me.is_impl) then
+            return
+        end
+        me.no_fins = (me.has_fins ~= true)
+
+        -- pools of the base may hold any of its dynamic codes
+        if me.dyn_base then
+            me.dyn_base.no_fins = (me.dyn_base.no_fins ~= false) and me.no_fins
+        end
+
+        local blk = AST.par(me, 'Block')
+        local old = DCLS.get(blk, me.id)
+        if old and old~=me and (not old.is_dyn_base) then
+            old.no_fins = me.no_fins
+        end
+    end,
+}
+
+AST.visit(H)
@@ -148,13 +148,14 @@ F = {
         local args = ''
         if CEU.opts.ceu_features_trace then
             local v = '__ceu_'..me.n
+            local site = 'CEU_TRACE_SITE('..CEU.trace_file(me.ln[1])..','..me.ln[2]..')'
             args = args .. [[,
 
 #if defined(__GNUC__) && defined(__cplusplus)
-({tceu_trace ]]..v..';'..v..'.up=&_ceu_mem->trace;'..v..'.file="'..me.ln[1]..'";'..v..'.line='..me.ln[2]..'; __ceu_'..me.n..[[;})
+({tceu_trace ]]..v..';'..v..'.mem=_ceu_mem;'..v..'.site='..site..'; __ceu_'..me.n..[[;})
 
 #else
-(tceu_trace) { &_ceu_mem->trace, "]]..me.ln[1]..'",'..me.ln[2]..[[ }
+(tceu_trace) { _ceu_mem, ]]..site..[[ }
 
 #endif
 ]]
@@ -283,7 +284,7 @@ CEU_CODE_]]..ID_abs.dcl.id_..'('..V(Abs_Cons)..','..mem..args..[[)
                             if not MEMS.datas.casts[name] then
                                 MEMS.datas.casts[name] = true
                                 MEMS.datas.casts[#MEMS.datas.casts+1] = [[
-]]..TYPES.toc(var_tp)..' '..name..[[ (]]..TYPES.toc(val.info.tp)..[[ x)
+static inline ]]..TYPES.toc(var_tp)..' '..name..[[ (]]..TYPES.toc(val.info.tp)..[[ x)
 {
     return (*(]]..TYPES.toc(var_tp)..[[*)&x);
 }
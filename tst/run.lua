@@ -85,6 +85,34 @@ if TESTS.cmd then
     assert(ok==true and mode=='exit' and status==0 and
            string.find(out, 'CEU_C.*ceu_vector.*tceu_app CEU_APP.*ceu_bcast.*ceu_loop'))
 
+    --$ ceu --pre --pre-input=/tmp/xxx.ceu --ceu --ceu-profile=true
+    -- OK (report in stderr)
+
+    local f = assert(io.popen('ceu --pre --pre-input='..tmp1..' '..
+                                  '--ceu --ceu-output=/dev/null --ceu-profile=true 2>&1'))
+    local out = f:read'*a'
+    local ok,mode,status = f:close()
+    assert(ok==true and mode=='exit' and status==0 and
+           string.find(out, '^CEU_PROFILE = {.*id="parser".*id="codes".*id="CEU_CODES".*secs = '))
+    local t = assert(load('return '..string.match(out,'^CEU_PROFILE = (.*)$')))()
+    assert(#t.phases>0 and #t.sections>0)
+
+    --$ ceu --pre --pre-input=/tmp/xxx.ceu --ceu --ceu-cache=/tmp/xxx (x2)
+    -- OK (same output, second from the cache)
+
+    local dir = os.tmpname()
+    os.remove(dir)
+    local outs = {}
+    for i=1, 2 do
+        local f = assert(io.popen('ceu --pre --pre-input='..tmp1..' '..
+                                      '--ceu --ceu-cache='..dir))
+        outs[i] = f:read'*a'
+        local ok,mode,status = f:close()
+        assert(ok==true and mode=='exit' and status==0)
+    end
+    assert(outs[1]==outs[2] and string.find(outs[1], 'CEU_C.*tceu_app CEU_APP'))
+    os.execute('rm -rf '..dir)
+
     --$ ceu --pre --pre-input=/tmp/xxx.ceu --env
     -->>> ERROR
 
@@ -261,10 +289,12 @@ end
     end
 
     TESTS.stats.count = TESTS.stats.count + 1
+    __inlines = false   -- in case the previous test failed while inlining
 
     local DIR = '../src/lua/'
 
     dofile(DIR..'dbg.lua')
+    dofile(DIR..'cache.lua')
     DBG,ASR = DBG1,ASR1
     if not check(T,'cmd') then return end
 
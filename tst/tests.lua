@@ -6685,6 +6685,63 @@ escape 1;
     _opts = { ceu_features_dynamic='true' },
 }
 
+-- loops without `break`/`continue` share their trail with the body
+
+Test { [[
+native _TRAILS;
+native/pos do
+    ##define TRAILS ((int)(sizeof(CEU_APP.root._trails)/sizeof(tceu_trl)))
+end
+input none A;
+input none B;
+var int n = 0;
+par/or do
+    every A do
+        n = n + 1;
+    end
+with
+    var int v = do
+        loop do
+            await A;
+            n = n + 10;
+            if n > 100 then
+                escape n;
+            end
+        end
+    end;
+    n = v;
+with
+    await B;
+end
+await A;
+escape _TRAILS*10 + n;
+]],
+    run = { ['~>A;~>A;~>B;~>A']=72 },     -- 5 trails (7 with CLEAR slots)
+}
+
+Test { [[
+native _TRAILS;
+native/pos do
+    ##define TRAILS ((int)(sizeof(((tceu_code_mem_Ff*)0)->_trails)/sizeof(tceu_trl)))
+end
+code/tight Ff (none) -> int do
+    var int s = 0;
+    var int i;
+    loop i in [0 -> 10[ do
+        if i == 5 then
+            break;
+        end
+        loop _ in [0 -> 2[ do
+            s = s + i;
+        end
+    end
+    escape s;
+end
+escape _TRAILS*10 + call Ff();
+]],
+    run = 30,
+}
+
 --<<< LOOP
 
 Test { [[
@@ -38086,6 +38143,77 @@ escape (f? as int) + 1;
     consts = 'line 6 : not implemented : dynamic limit for pools',
 }
 
+Test { [[
+code/await Ff (none) -> NEVER do
+    await FOREVER;
+end
+var int n = 2;
+pool[1->n] Ff ffs;
+spawn Ff() in ffs;
+escape 1;
+]],
+    _opts = { ceu_features_dynamic='true', ceu_features_pool='true' },
+    consts = 'line 5 : not implemented : dynamic limit for pools',
+}
+Test { [[
+code/await Ff (none) -> NEVER do
+    await FOREVER;
+end
+pool[1->2] Ff ffs;
+spawn Ff() in ffs;
+escape 1;
+]],
+    _opts = { ceu_features_pool='true' },
+    dcls = 'line 4 : dynamic allocation support is disabled',
+}
+Test { [[
+code/await Ff (var& int n) -> none do
+    n = n + 1;
+    await FOREVER;
+end
+code/await Gg (var& int n, pool&[] Ff fs) -> none do
+    var int i;
+    loop i in [0 -> 5[ do
+        spawn Ff(&n) in fs;
+    end
+end
+var int n = 0;
+pool[1->3] Ff fs;
+await Gg(&n, &fs);
+var int m = 0;
+var&? Ff f;
+loop f in fs do
+    m = m + 1;
+end
+escape n*10 + m;
+]],
+    _opts = { ceu_features_dynamic='true', ceu_features_pool='true' },
+    run = 33,
+}
+Test { [[
+code/await Ff (none) -> none do
+    await 1s;
+end
+pool[1->] Ff fs;
+var int i;
+loop i in [0 -> 3[ do
+    var int j;
+    loop j in [0 -> 10[ do
+        spawn Ff() in fs;
+    end
+    await 1s;
+end
+var int m = 0;
+var&? Ff f;
+loop f in fs do
+    m = m + 1;
+end
+escape m;
+]],
+    _opts = { ceu_features_dynamic='true', ceu_features_pool='true' },
+    run = { ['~>3s']=0 },
+}
+
 Test { [[
 code/await Ff (none) -> (var& int x) -> none do
     var int v = 10;
@@ -42531,6 +42659,74 @@ escape 1;
 ]],
     run = 1,
 }
+
+Test { [[
+event none e;
+var int ret = 0;
+code/await Ff (event& none e, var& int ret) -> none do
+    await 1s;
+    emit e;
+    ret = ret + 100;
+end
+par/or do
+    pool[2] Ff fs;
+    spawn Ff(&e, &ret) in fs;
+    spawn Ff(&e, &ret) in fs;
+    await FOREVER;
+with
+    await e;
+    ret = ret + 1;
+end
+escape ret;
+]],
+    run = { ['~>1s']=1 },
+    _opts = { ceu_features_pool='true' },
+}
+Test { [[
+event none e;
+var int ret = 0;
+code/await Ff (event& none e, var& int ret) -> none do
+    do finalize with
+        ret = ret * 10;
+    end
+    await 1s;
+    emit e;
+    ret = ret + 100;
+end
+par/or do
+    pool[] Ff fs;
+    spawn Ff(&e, &ret) in fs;
+    spawn Ff(&e, &ret) in fs;
+    await FOREVER;
+with
+    await e;
+    ret = ret + 1;
+end
+escape ret;
+]],
+    run = { ['~>1s']=100 },
+    _opts = { ceu_features_dynamic='true', ceu_features_pool='true' },
+}
+Test { [[
+event none e;
+var int ret = 0;
+code/await Ff (event& none e, var& int ret) -> none do
+    emit e;
+    ret = ret + 100;
+end
+var int i;
+loop i in [0 -> 3[ do
+    par/or do
+        await e;
+        ret = ret + 1;
+    with
+        await Ff(&e, &ret);
+    end
+end
+escape ret;
+]],
+    run = 3,
+}
 --<<< CODE / AWAIT / FUNCTIONS
 
 -- TODO: SKIP-03
@@ -45829,6 +46025,43 @@ escape ret;
     _opts = { ceu_features_exception='true' },
 }
 
+Test { [[
+var int ret = 0;
+
+code/await Ff (var int i) -> none do
+    var int n = 0;
+    loop do
+        await 1s;
+        var Exception? e;
+        catch e do
+            par/or do
+                do finalize with
+                    outer.ret = outer.ret*10 + i;
+                end
+                await FOREVER;
+            with
+                var Exception e_ = val Exception(_);
+                throw e_;
+            end
+        end
+        n = n + 1;
+        if n == 2 then
+            break;
+        end
+    end
+    outer.ret = outer.ret*10 + 9;
+end
+
+pool[2] Ff fs;
+spawn Ff(1) in fs;
+spawn Ff(2) in fs;
+await 3s;
+escape ret;
+]],
+    run = { ['~>3s']=121929 },
+    _opts = { ceu_features_exception='true', ceu_features_pool='true' },
+}
+
 Test { [[
 var Exception e = val Exception(_);
 throw e;
@@ -55593,3 +55826,1233 @@ escape 1;
 }
 
 --<<< CEU_FEATURES_*
+
+-->>> LAYOUT
+
+Test { [[
+native _SZ;
+native/pos do
+    ##define SZ ((int)sizeof(tceu_data_Dd))
+end
+data Dd with
+    var u8  a;
+    var s64 b;
+    var u8  c;
+    var int d;
+end
+var Dd d = val Dd(1,2,3,4);
+escape _SZ + (d.a as int) + (d.b as int) + (d.c as int) + d.d;
+]],
+    _opts = { ceu_layout_aligned='true' },
+    run = 26,
+}
+
+Test { [[
+code/await Ff (var u8 x, var s64 y, var bool z) -> int do
+    var u8   a = x;
+    var bool b = z;
+    var s64  c = y;
+    var u16  d = 4;
+    await async do end;
+    escape (a as int) + (b as int) + (c as int) + (d as int);
+end
+var int r = await Ff(1,2,true);
+escape r;
+]],
+    _opts = { ceu_layout_aligned='true' },
+    run = 8,
+}
+
+Test { [[
+data Aa with
+    var u8 a;
+end
+data Aa.Bb with
+    var s64 b;
+    var u8  c;
+end
+
+code/await/dynamic Ff (var&/dynamic Aa a, var u8 xxx) -> int do
+    escape (a.a as int) + (xxx as int);
+end
+code/await/dynamic Ff (var&/dynamic Aa.Bb b, var u8 yyy) -> int do
+    escape (b.a as int) + (b.b as int) + (b.c as int) + (yyy as int);
+end
+
+var Aa    a = val Aa(1);
+var Aa.Bb b = val Aa.Bb(2,3,4);
+
+var int v1 = await/dynamic Ff(&b,22);
+var int v2 = await/dynamic Ff(&a,33);
+
+escape v1 + v2;
+]],
+    _opts = { ceu_layout_aligned='true' },
+    run = 65,
+}
+
+--<<< LAYOUT
+
+-->>> INLINES
+
+Test { [[
+input int A;
+code/await Ff (var int x) -> int do
+    var int y = await A;
+    escape x + y;
+end
+var int a = await Ff(1);
+var int b = 0;
+par/and do
+    b = await Ff(10);
+with
+    var int c = await Ff(100);
+    b = b + c;
+end
+escape a + b;
+]],
+    _opts = { ceu_inline_budget='100' },
+    run = { ['1~>A;2~>A']=116 },
+}
+
+Test { [[
+input int A;
+code/await Ff (var int x) -> int do
+    var int y = await A;
+    escape x + y;
+end
+var int x = 10;
+var int y = await Ff(x);
+escape x + y;
+]],
+    _opts = { ceu_inline_budget='0' },
+    run = { ['1~>A']=21 },
+}
+
+Test { [[
+input int A;
+var int ret = 0;
+code/await Gg (var& int r) -> none do
+    every A do
+        r = r + 1;
+    end
+end
+spawn Gg(&ret);
+await A;
+await A;
+escape ret;
+]],
+    _opts = { ceu_inline_budget='0' },
+    run = { ['1~>A;2~>A']=2 },
+}
+
+Test { [[
+native _TRAILS;
+native/pos do
+    ##define TRAILS ((int)(sizeof(CEU_APP.root._trails)/sizeof(tceu_trl)))
+end
+input int A;
+code/await Ff (var int x) -> int do
+    var int y = await A;
+    escape x + y;
+end
+var int x = 10;
+var int y = await Ff(x);
+escape _TRAILS*100 + x + y;
+]],
+    _opts = { ceu_inline_budget='0' },
+    run = { ['1~>A']=221 },     -- inlined: no trails for "Ff"
+}
+
+Test { [[
+native _TRAILS, _ceu_assert;
+native/pos do
+    ##define TRAILS ((int)(sizeof(CEU_APP.root._trails)/sizeof(tceu_trl)))
+end
+input int A;
+code/await Ff (var int x) -> int do
+    _ceu_assert(x > 0, "bug found");
+    var int y = await A;
+    escape x + y;
+end
+var int x = 10;
+var int y = await Ff(x);
+escape _TRAILS*100 + x + y;
+]],
+    _opts = { ceu_inline_budget='0' },
+    run = { ['1~>A']=421 },     -- not inlined: native of the runtime
+}
+
+Test { [[
+native _TRAILS;
+native/pure _abs;
+native/pre do
+    ##include <stdlib.h>
+end
+native/pos do
+    ##define TRAILS ((int)(sizeof(CEU_APP.root._trails)/sizeof(tceu_trl)))
+end
+input int A;
+code/await Ff (var int x) -> int do
+    var int y = await A;
+    escape _abs(x) + y;
+end
+var int x = -10;
+var int y = await Ff(x);
+escape _TRAILS*100 + x + y;
+]],
+    _opts = { ceu_inline_budget='0' },
+    run = { ['1~>A']=201 },     -- inlined: "pure" native
+}
+
+--<<< INLINES
+
+-->>> INPUT TABLES
+
+Test { [[
+input int A;
+input int B;
+code/await Ff (none) -> int do
+    var int a = await A;
+    var int b = await B;
+    escape a + b;
+end
+var int x = await Ff();
+escape x;
+]],
+    _opts = { ceu_input_tables='true' },
+    run = { ['1~>B;2~>A;3~>B']=5 },
+}
+
+Test { [[
+input int B;
+code/await Ff (none) -> none do
+    await 1s;
+end
+code/await Gg (none) -> NEVER do
+    await Ff();
+    await FOREVER;
+end
+pool[2] Gg gs;
+spawn Gg() in gs;
+spawn Gg() in gs;
+var int x = await B;
+escape x;
+]],
+    _opts = { ceu_input_tables='true', ceu_features_pool='true' },
+    run = { ['~>2s;7~>B']=7 },
+}
+
+Test { [[
+input int A;
+input int B;
+event bool e;
+var int x = 0;
+par/or do
+    pause/if e do
+        every A do
+            x = x + 1;
+        end
+    end
+with
+    await B;
+    emit e(true);
+    await B;
+    emit e(false);
+    await B;
+end
+escape x;
+]],
+    _opts = { ceu_input_tables='true', ceu_features_pause='true' },
+    run = { ['1~>A;1~>A;1~>B;1~>A;1~>B;1~>A;1~>B']=3 },
+}
+
+--<<< INPUT TABLES
+
+-->>> STATS
+
+Test { [[
+input int A;
+native/plain _tceu_stats;
+native _CEU_INPUT_A;
+native/nohold _ceu_stats;
+var[] int vs = [1,2,3];
+await A;
+await A;
+var _tceu_stats s = _;
+_ceu_stats(&&s);
+escape (s.reactions[_CEU_INPUT_A] as int)*100 + (s.vector_reallocs as int)*10 + (s.level_max as int);
+]],
+    _opts = { ceu_features_stats='true', ceu_features_dynamic='true' },
+    run = { ['1~>A;2~>A']=212 },
+}
+
+Test { [[
+native/plain _tceu_stats;
+native/nohold _ceu_stats;
+code/await Ff (none) -> NEVER do
+    await FOREVER;
+end
+pool[3] Ff fs;
+spawn Ff() in fs;
+spawn Ff() in fs;
+var _tceu_stats s = _;
+_ceu_stats(&&s);
+escape (s.pool_n as int)*10 + (s.pool_max as int);
+]],
+    _opts = { ceu_features_stats='true', ceu_features_pool='true' },
+    run = 22,
+}
+
+Test { [[
+native/plain _tceu_stats;
+native/nohold _ceu_stats;
+code/await Ff (var& int n) -> none do
+    do finalize with
+        n = n + 1;
+    end
+    await FOREVER;
+end
+var int n = 0;
+var _tceu_stats s = _;
+do
+    pool[2->4] Ff fs;
+    var int i;
+    loop i in [0 -> 6[ do
+        spawn Ff(&n) in fs;
+    end
+    _ceu_stats(&&s);
+end
+escape n*1000 + (s.pool_n as int)*100 + (s.pool_overflows as int)*10 + (s.pool_fails as int);
+]],
+    _opts = { ceu_features_stats='true', ceu_features_pool='true', ceu_features_dynamic='true' },
+    run = 4422,
+}
+
+Test { [[
+native/plain _tceu_stats;
+native/nohold _ceu_stats;
+native _CEU_INPUT__NONE, _CEU_INPUT__CLEAR, _CEU_INPUT__CODE_TERMINATED, _CEU_INPUT_A;
+input none A;
+code/await Ff (none) -> none do
+    await A;
+end
+par/or do
+    await Ff();
+with
+    await A;
+end
+var _tceu_stats s = _;
+_ceu_stats(&&s);
+escape (s.reactions[_CEU_INPUT__NONE] as int)*1000 +
+       (s.reactions[_CEU_INPUT_A] as int)*100 +
+       (s.reactions[_CEU_INPUT__CLEAR] as int)*10 +
+       (s.reactions[_CEU_INPUT__CODE_TERMINATED] as int);
+]],
+    _opts = { ceu_features_stats='true' },
+    run = { ['~>A']=1100 },
+}
+
+--<<< STATS
+
+-->>> RECORD
+
+Test { [[
+native/pos do
+    int N = 0;
+    int CB_F (int cmd, tceu_callback_val p1, tceu_callback_val p2) {
+        if (cmd == CEU_CALLBACK_RECORD) {
+            tceu_record* rec = (tceu_record*) p2.ptr;
+            if (rec->id==CEU_INPUT__ASYNC && rec->size==0 && rec->dt==CEU_WCLOCK_INACTIVE) {
+                N++;
+            }
+        }
+        return 0;
+    }
+    tceu_callback CB = { &CB_F, NULL };
+end
+{ ceu_callback_register(&CB); }
+native _N;
+var int i;
+loop i in [0 -> 3[ do
+    await async do end
+end
+escape _N;
+]],
+    _opts = { ceu_features_record='true' },
+    run = 3,
+}
+
+Test { [[
+input int A;
+native/pos do
+    int N = 0;
+    int CB_F (int cmd, tceu_callback_val p1, tceu_callback_val p2) {
+        if (cmd==CEU_CALLBACK_STEP && N<2) {
+            tceu_input_A p = { 10 };
+            ceu_input(CEU_INPUT_A, &p);
+        } else if (cmd == CEU_CALLBACK_RECORD) {
+            tceu_record* rec = (tceu_record*) p2.ptr;
+            if (rec->id==CEU_INPUT_A && rec->size==sizeof(tceu_input_A) &&
+                ((tceu_input_A*)rec->params)->_1==10)
+            {
+                N++;
+            }
+        }
+        return 0;
+    }
+    tceu_callback CB = { &CB_F, NULL };
+end
+{ ceu_callback_register(&CB); }
+native _N;
+await A;
+await A;
+escape _N;
+]],
+    _opts = { ceu_features_record='true' },
+    run = 2,
+}
+
+--<<< RECORD
+
+-->>> SNAPSHOT
+
+Test { [[
+native/pos do
+    tceu_snapshot SNAP;
+    byte IMAGE[sizeof(tceu_app)];
+    int STEPS    = 0;
+    int RESTORES = 0;
+    int CB_F (int cmd, tceu_callback_val p1, tceu_callback_val p2) {
+        if (cmd == CEU_CALLBACK_STEP) {
+            STEPS++;
+            if (STEPS == 1) {
+                ceu_snapshot_save(&SNAP);
+                memcpy(IMAGE, SNAP.image, SNAP.size);
+                SNAP.image = IMAGE;
+            } else if (STEPS == 3) {
+                RESTORES += ceu_snapshot_restore(&SNAP);
+            }
+        }
+        return 0;
+    }
+    tceu_callback CB = { &CB_F, NULL };
+end
+{ ceu_callback_register(&CB); }
+native _RESTORES;
+var int n = 0;
+var int i;
+loop i in [0 -> 3[ do
+    await async do end
+    n = n + 1;
+end
+escape n*10 + _RESTORES;
+]],
+    _opts = { ceu_features_snapshot='true' },
+    run = 31,
+}
+
+Test { [[
+native/pos do
+    tceu_snapshot SNAP;
+    byte IMAGE[sizeof(tceu_app)];
+    int STEPS    = 0;
+    int RESTORES = 0;
+    int CB_F (int cmd, tceu_callback_val p1, tceu_callback_val p2) {
+        if (cmd == CEU_CALLBACK_STEP) {
+            STEPS++;
+            if (STEPS == 1) {
+                ceu_snapshot_save(&SNAP);
+                memcpy(IMAGE, SNAP.image, SNAP.size);
+                SNAP.image = IMAGE;
+                SNAP.app  += sizeof(usize);     // as if loaded elsewhere
+            } else if (STEPS == 3) {
+                RESTORES += ceu_snapshot_restore(&SNAP);
+            }
+        }
+        return 0;
+    }
+    tceu_callback CB = { &CB_F, NULL };
+end
+{ ceu_callback_register(&CB); }
+native _RESTORES;
+var int n = 0;
+var int i;
+loop i in [0 -> 3[ do
+    await async do end
+    n = n + 1;
+end
+escape n*10 + _RESTORES;
+]],
+    _opts = { ceu_features_snapshot='true' },
+    run = 30,
+}
+
+Test { [[
+native/pre do
+    ##define CEU_CALLBACK_ENV CB
+end
+native/pos do
+    tceu_snapshot SNAP;
+    byte IMAGE[sizeof(tceu_app)];
+    int STEPS   = 0;
+    int REARMED = 0;
+    int CB_F (int cmd, tceu_callback_val p1, tceu_callback_val p2) {
+        switch (cmd) {
+            case CEU_CALLBACK_STEP:
+                STEPS++;
+                if (STEPS == 1) {
+                    ceu_snapshot_save(&SNAP);
+                    memcpy(IMAGE, SNAP.image, SNAP.size);
+                    SNAP.image = IMAGE;
+                } else if (STEPS == 3) {
+                    ceu_start(CEU_APP.cbs_env, CEU_APP.argc, CEU_APP.argv);    // restarts
+                }
+                break;
+            case CEU_CALLBACK_SNAPSHOT:
+                if (STEPS == 3) {
+                    ceu_callback_ret.ptr = &SNAP;
+                    return 1;
+                }
+                break;
+            case CEU_CALLBACK_WCLOCK_MIN:
+                if (STEPS == 3) {
+                    REARMED = (p1.num == 10000000);
+                }
+                break;
+        }
+        return 0;
+    }
+    tceu_callback CB = { &CB_F, NULL };
+end
+native _REARMED;
+var int n = 0;
+par/or do
+    await 10s;
+    n = 100;
+with
+    var int i;
+    loop i in [0 -> 3[ do
+        await async do end
+        n = n + 1;
+    end
+end
+escape n*10 + _REARMED;
+]],
+    _opts = { ceu_features_snapshot='true' },
+    run = 31,
+}
+
+Test { [[
+escape 1;
+]],
+    _opts = { ceu_features_snapshot='true', ceu_features_dynamic='true' },
+    cmd = 'invalid option `ceu-features-snapshot` : incompatible with `ceu-features-dynamic`',
+}
+
+--<<< SNAPSHOT
+
+-->>> HITS
+
+Test { [[
+native _CEU_APP, _CEU_LABEL_ROOT;
+escape (_CEU_APP.hits[_CEU_LABEL_ROOT] as int)*10 + (_CEU_APP.lbl_cur as int);
+]],
+    _opts = { ceu_features_hits='true' },
+    run = 11,
+}
+
+--<<< HITS
+
+-->>> OUTPUT BATCH
+
+Test { [[
+native/pos do
+    int B = 0;
+    int S = 0;
+    int CB_F (int cmd, tceu_callback_val p1, tceu_callback_val p2) {
+        if (cmd == CEU_CALLBACK_OUTPUT_BATCH) {
+            tceu_output* o = (tceu_output*) ((tceu_output_batch*)p2.ptr)->buf;
+            int i;
+            for (i=0; i<p1.num; i++) {
+                S = S*10 + *((int*)o->params);
+                o = CEU_OUTPUT_NXT(o);
+            }
+            B++;
+            ceu_callback_ret.num = 1;
+            return 1;
+        } else if (cmd == CEU_CALLBACK_OUTPUT) {
+            S = S*10 + 9;
+            ceu_callback_ret.num = 0;
+            return 1;
+        }
+        return 0;
+    }
+    tceu_callback CB = { &CB_F, NULL };
+end
+{ ceu_callback_register(&CB); }
+native _B, _S;
+output int O;
+output none P;
+emit O(1);
+emit O(2);
+var int ret = emit P();
+emit O(3);
+await async do end;
+escape _B*10000 + _S + ret;
+]],
+    _opts = { ceu_features_output_batch='true' },
+    run = 21293,
+}
+
+Test { [[
+native/pos do
+    int S = 0;
+    int CB_F (int cmd, tceu_callback_val p1, tceu_callback_val p2) {
+        if (cmd == CEU_CALLBACK_OUTPUT) {
+            S = S*10 + *((int*)p2.ptr);
+            return 1;
+        }
+        return 0;
+    }
+    tceu_callback CB = { &CB_F, NULL };
+end
+{ ceu_callback_register(&CB); }
+native _S;
+output int O;
+emit O(1);
+emit O(2);
+var int s = _S;
+await async do end;
+escape s*100 + _S;
+]],
+    _opts = { ceu_features_output_batch='true' },
+    run = 12,
+}
+
+Test { [[
+native/pos do
+    int B = 0;
+    int S = 0;
+    int CB_F (int cmd, tceu_callback_val p1, tceu_callback_val p2) {
+        if (cmd == CEU_CALLBACK_OUTPUT_BATCH) {
+            tceu_output* o = (tceu_output*) ((tceu_output_batch*)p2.ptr)->buf;
+            int i;
+            for (i=0; i<p1.num; i++) {
+                S = S*10 + *((int*)o->params);
+                o = CEU_OUTPUT_NXT(o);
+            }
+            B++;
+            ceu_callback_ret.num = 1;
+            return 1;
+        } else if (cmd == CEU_CALLBACK_OUTPUT) {
+            S = S*10 + *((int*)p2.ptr);
+            return 1;
+        }
+        return 0;
+    }
+    tceu_callback CB = { &CB_F, NULL };
+end
+{ ceu_callback_register(&CB); }
+native _B, _S;
+output int O;
+output (int) Q;
+output (int v) Q do
+    emit O(v);
+end
+emit O(1);
+emit Q(2);
+emit O(3);
+await async do end;
+escape _B*1000 + _S;
+]],
+    _opts = { ceu_features_output_batch='true' },
+    run = 2123,
+}
+
+--<<< OUTPUT BATCH
+
+-->>> ASYNC BUDGET
+
+Test { [[
+native/plain _tceu_stats;
+native/nohold _ceu_stats;
+native _CEU_INPUT__ASYNC;
+var int sum = 0;
+await async (sum) do
+    var int i;
+    loop i in [0 -> 100[ do
+        sum = sum + i;
+    end
+end
+var _tceu_stats s = _;
+_ceu_stats(&&s);
+escape (s.reactions[_CEU_INPUT__ASYNC] as int)*10 + ((sum == 4950) as int);
+]],
+    _opts = { ceu_features_stats='true', ceu_async_budget='32' },
+    run = 41,
+}
+
+Test { [[
+input int A;
+var int n = 0;
+par/or do
+    every A do
+        n = n + 1;
+    end
+with
+    await async do
+        var int i;
+        loop i in [0 -> 10[ do
+            emit A(i);
+        end
+    end
+end
+escape n;
+]],
+    _opts = { ceu_async_budget='4' },
+    run = 10,
+}
+
+Test { [[
+code/await Ff (none) -> int do
+    var int sum = 0;
+    await async (sum) do
+        var int i;
+        loop i in [0 -> 10[ do
+            sum = sum + i;
+        end
+    end
+    escape sum;
+end
+input int A;
+var int n = 0;
+par/or do
+    every A do
+        n = n + 1;
+    end
+with
+    var int v = await Ff();
+    await async do
+        emit A(1);
+    end
+    escape v + n;
+end
+]],
+    _opts = { ceu_async_budget='3', ceu_input_tables='true' },
+    run = 46,
+}
+
+--<<< ASYNC BUDGET
+
+-->>> CALLBACKS DISPATCH
+
+Test { [[
+native/pos do
+    int N = 0;
+    int CB_F (int cmd, tceu_callback_val p1, tceu_callback_val p2) {
+        N = N + p1.num;
+        ceu_callback_ret.num = 10;
+        return 1;
+    }
+end
+{ ceu_callback_register_cmd(CEU_CALLBACK_OUTPUT, &CB_F); }
+native _N;
+output int O;
+var int ret = emit O(1);
+escape ret + _N;
+]],
+    _opts = { ceu_features_callback_table='true' },
+    run = 11,
+}
+
+Test { [[
+native/pos do
+    int ceu_output_O (tceu_output_O* ps) {
+        return ps->_1 * 2;
+    }
+    int ceu_output_P (void) {
+        return 1;
+    }
+end
+output int O;
+output none P;
+var int a = emit O(10);
+var int b = emit P();
+escape a + b;
+]],
+    _opts = { ceu_output_functions='true' },
+    run = 21,
+}
+
+--<<< CALLBACKS DISPATCH
+
+-->>> IO
+
+Test { [[
+#include "c.ceu"
+#include "io.ceu"
+native/pre do
+    ##include <unistd.h>
+    int FDS[2];
+end
+native _FDS, _pipe;
+_pipe(&&_FDS[0]);
+_ceu_io_nonblock(_FDS[0]);
+_ceu_io_nonblock(_FDS[1]);
+var[] byte src = [] .. "hello";
+var[] byte dst;
+var int r = _;
+var int w = _;
+par/and do
+    r = await Io_Read(_FDS[0], &dst);
+with
+    w = await Io_Write(_FDS[1], &src);
+end
+escape r + w + _strlen(&&dst[0] as _char&&);
+]],
+    wrn = true,
+    opts_pre = true,
+    _opts = { ceu_features_dynamic='true' },
+    run = 17,
+}
+
+Test { [[
+#include "c.ceu"
+#include "io.ceu"
+native/pre do
+    ##include <fcntl.h>
+    ##include <unistd.h>
+    int FDS[2];
+end
+native _FDS, _pipe;
+_pipe(&&_FDS[0]);
+_ceu_io_nonblock(_FDS[0]);
+_ceu_io_nonblock(_FDS[1]);
+var[10] byte buf;
+par/or do
+    await Io_Read(_FDS[0], &buf);   // canceled on abort
+with
+    nothing;
+end
+var[] byte src = [] .. "ab";
+var int w  = await Io_Write(_FDS[1], &src);
+var int r1 = await Io_Read(_FDS[0], &buf);
+_ceu_io_close(_FDS[1]);
+var int r2 = await Io_Read(_FDS[0], &buf);     // EOF
+var int nul = _open("/dev/null", _O_RDONLY);
+var int r3 = await Io_Read(nul, &buf);         // EOF (read when requested)
+var int r4 = await Io_Accept(nul);             // -EPERM (not pollable)
+escape w*10 + r1 + r2 + r3 - r4;
+]],
+    wrn = true,
+    opts_pre = true,
+    _opts = { ceu_features_dynamic='true' },
+    run = 34,
+}
+
+Test { [[
+#include "c.ceu"
+#include "io.ceu"
+native/pre do
+    ##include <fcntl.h>
+    ##include <stdio.h>
+    int FILE_ (void) {
+        FILE* f = fopen("/tmp/_ceu_io.txt", "w");
+        fputs("abc", f);
+        fclose(f);
+        return open("/tmp/_ceu_io.txt", O_RDONLY);
+    }
+end
+native _FILE_;
+var int fd = _FILE_();
+var[10] byte buf;
+var int r1 = await Io_Read(fd, &buf);          // short read
+var int r2 = await Io_Read(fd, &buf);          // EOF (regular files are not pollable)
+_ceu_io_close(fd);
+escape r1*10 + r2 + ($buf as int);
+]],
+    wrn = true,
+    opts_pre = true,
+    run = 33,
+}
+
+--<<< IO
+
+-->>> PAR
+
+Test { [[
+#include "par.ceu"
+code/tight Square (var int&& x, var int&& k) -> none do
+    *x = (*x)*(*x) + *k;
+end
+native _CEU_PAR_Square;
+var[] int v;
+var int i;
+loop i in [0 -> 10000[ do
+    v = v .. [i];
+end
+var int k = 1;
+var int ret = await Par_For(&&v, _CEU_PAR_Square, &&k);
+var int n = 0;
+loop i in [0 -> 10000[ do
+    if v[i] == i*i+1 then
+        n = n + 1;
+    end
+end
+escape ret + n/1000;
+]],
+    wrn = true,
+    opts_pre = true,
+    _opts = { ceu_features_dynamic='true' },
+    run = 10,
+}
+
+Test { [[
+#include "par.ceu"
+code/tight Set (var int&& x, var int&& k) -> none do
+    *x = *k;
+end
+native _CEU_PAR_Set;
+var[] int v = [1,2,3];
+var[] int e;
+var int k = 5;
+par/or do
+    await Par_For(&&v, _CEU_PAR_Set, &&k);  // joined on abort
+with
+    nothing;
+end
+k = 7;
+var int r1 = await Par_For(&&e, _CEU_PAR_Set, &&k);
+var int r2 = await Par_For(&&v, _CEU_PAR_Set, &&k);
+escape r1 + r2 + v[0] + v[1] + v[2];
+]],
+    wrn = true,
+    opts_pre = true,
+    _opts = { ceu_features_dynamic='true' },
+    run = 21,
+}
+
+Test { [[
+#include "par.ceu"
+var int g = 0;
+code/tight Gg (var int v) -> none do
+    outer.g = v;
+end
+code/tight Set (var int&& x, var int&& k) -> none do
+    *x = *k;
+    call Gg(*k);
+end
+native _CEU_PAR_Set;
+var[] int v = [1];
+var int k = 1;
+await Par_For(&&v, _CEU_PAR_Set, &&k);
+escape 0;
+]],
+    wrn = true,
+    opts_pre = true,
+    _opts = { ceu_features_dynamic='true' },
+    tight_ = 'invalid `Par_For` kernel : unexpected `outer`',
+}
+
+Test { [[
+#include "par.ceu"
+native _printf;
+code/tight Set (var int&& x, var int&& k) -> none do
+    _printf("%d\n", *k);
+end
+native _CEU_PAR_Set;
+var[] int v = [1];
+var int k = 1;
+await Par_For(&&v, _CEU_PAR_Set, &&k);
+escape 0;
+]],
+    wrn = true,
+    opts_pre = true,
+    _opts = { ceu_features_dynamic='true' },
+    tight_ = 'invalid `Par_For` kernel : expected `pure` native',
+}
+
+Test { [[
+#include "par.ceu"
+code/tight Set (var int x) -> none do
+end
+native _CEU_PAR_Set;
+var[] int v = [1];
+var int k = 1;
+await Par_For(&&v, _CEU_PAR_Set, &&k);
+escape 0;
+]],
+    wrn = true,
+    opts_pre = true,
+    _opts = { ceu_features_dynamic='true' },
+    tight_ = 'invalid `Par_For` kernel : expected `(var T&& x, var U&& arg) -> none`',
+}
+
+Test { [[
+#include "par.ceu"
+native/pre do
+    void SET (void* buf, usize i0, usize i1, void* arg) {}
+end
+native _SET;
+var[] int v = [1];
+var int k = 1;
+await Par_For(&&v, _SET, &&k);
+escape 0;
+]],
+    wrn = true,
+    opts_pre = true,
+    _opts = { ceu_features_dynamic='true' },
+    tight_ = 'invalid `Par_For` : expected kernel `_CEU_PAR_<id>`',
+}
+
+--<<< PAR
+
+-->>> CODE FUNCTIONS
+
+Test { [[
+input none A;
+code/await Tx (none) -> int
+do
+    code/await Fx (var int a)->int;
+    code/await Fx (var int a)->int do
+        await A;
+        escape a;
+    end
+    var int y = await Fx(10);
+    escape y;
+end
+var int x = await Tx();
+escape x;
+]],
+    _opts = { ceu_code_functions='true' },
+    run = { ['~>A']=10 },
+}
+
+Test { [[
+input int A;
+code/await Ff (var int x) -> none do
+    var int y = await A until y == x;
+end
+pool[] Ff fs;
+spawn Ff(1) in fs;
+spawn Ff(2) in fs;
+spawn Ff(3) in fs;
+var int ret = 0;
+await A;
+var&? Ff f;
+loop f in fs do
+    ret = ret + 1;
+end
+escape ret;
+]],
+    _opts = { ceu_code_functions='true', ceu_features_pool='true', ceu_features_dynamic='true' },
+    run = { ['2~>A']=2 },
+}
+
+Test { [[
+code/await Ff (none) -> none
+    throws Exception
+do
+    var Exception e_ = val Exception(_);
+    throw e_;
+end
+var Exception? e;
+catch e do
+    await Ff();
+end
+if e? then
+    escape 10;
+end
+escape 1;
+]],
+    _opts = { ceu_code_functions='true', ceu_features_exception='true' },
+    run = 10,
+}
+
+--<<< CODE FUNCTIONS
+
+-->>> UNITS
+
+Test { [[
+input none A;
+code/await Ff (var int x) -> int do
+    await A;
+    escape x + 1;
+end
+code/await Gg (var int x) -> int do
+    var int y = await Ff(x);
+    escape y * 2;
+end
+var int ret = await Gg(10);
+escape ret;
+]],
+    _opts = { ceu_units='2' },
+    run = { ['~>A']=22 },
+}
+
+Test { [[
+code/tight/recursive Fat (var int x) -> int do
+    if x > 1 then
+        escape x * (call/recursive Fat(x-1));
+    else
+        escape 1;
+    end
+end
+escape call/recursive Fat(5);
+]],
+    _opts = { ceu_units='1' },
+    run = 120,
+}
+
+Test { [[
+code/await Tx (none)->none;
+code/await Tx (none)->none do
+end
+await Tx();
+await Tx();
+escape 1;
+]],
+    _opts = { ceu_units='2' },
+    run = 1,
+}
+
+Test { [[
+input int A;
+code/await Ff (var int x) -> none do
+    var int y = await A until y == x;
+end
+pool[2] Ff fs;
+spawn Ff(1) in fs;
+spawn Ff(2) in fs;
+var int ret = 0;
+var&? Ff f;
+loop f in fs do
+    ret = ret + 1;
+end
+await A;
+loop f in fs do
+    ret = ret + 10;
+end
+escape ret;
+]],
+    _opts = { ceu_units='3', ceu_features_pool='true' },
+    run = { ['2~>A']=12 },
+}
+
+Test { [[
+code/await Ff (none) -> none
+    throws Exception
+do
+    var Exception e_ = val Exception(_);
+    throw e_;
+end
+var Exception? e;
+catch e do
+    await Ff();
+end
+if e? then
+    escape 10;
+end
+escape 1;
+]],
+    _opts = { ceu_units='2', ceu_features_trace='true', ceu_features_exception='true' },
+    run = 10,
+}
+
+Test { [[
+code/await Ff (none) -> none do
+    var int x = 0;
+    {ceu_assert(0, "err");}
+end
+await Ff();
+escape 0;
+]],
+    _opts = { ceu_units='2', ceu_features_trace='true' },
+    run = '3] -> runtime error: err',
+}
+
+Test { [[
+code/await Ff (none) -> none do end
+escape 1;
+]],
+    _opts = { ceu_units='2', ceu_features_isr='true' },
+    cmd = 'incompatible with `ceu-features-isr`',
+}
+
+Test { [[
+native/pos do
+    int N = 0;
+end
+code/await Ff (none) -> none do end
+await Ff();
+escape 1;
+]],
+    _opts = { ceu_units='2' },
+    props_ = 'line 1 : invalid `native` block : unexpected global definition "N" : expected `static const`, or `extern` with the definition under `CEU_UNIT == 0` (see `--ceu-units`)',
+}
+
+Test { [[
+native/pos do
+    static int N = 0;
+end
+code/await Ff (none) -> none do end
+await Ff();
+escape 1;
+]],
+    _opts = { ceu_units='2' },
+    props_ = 'line 1 : invalid `native` block : unexpected global definition "N" : expected `static const`',
+}
+
+Test { [[
+native/pos do
+    static int f (void) {
+        static int n = 0;
+        return ++n;
+    }
+end
+escape 1;
+]],
+    _opts = { ceu_units='2' },
+    props_ = 'line 1 : invalid `native` block : unexpected global definition "n" : expected `static const`',
+}
+
+Test { [[
+native/pos do
+    int f (int x) { return x; }
+end
+escape 1;
+]],
+    _opts = { ceu_units='2' },
+    props_ = 'line 1 : invalid `native` block : unexpected global definition "f" : expected `static` (see `--ceu-units`)',
+}
+
+Test { [[
+native/pre do
+    ##include <stdio.h>
+    typedef struct { int x; } Tt;
+    extern Tt N;
+    static int f (int x);
+end
+native/pos do
+    ##if defined(CEU_UNIT_ALL) || (CEU_UNIT == 0)
+    Tt N = { 10 };          /* shared by all units */
+    ##endif
+    static const int M = 100;   /* int K = 0; */
+    static int f (int x) {
+        N.x = N.x + x;
+        return N.x;
+    }
+end
+native _f, _N, _M;
+code/await Ff (var int x) -> int do
+    escape _f(x);
+end
+var int ret = await Ff(1);
+escape _M + _N.x + ret;
+]],
+    _opts = { ceu_units='2' },
+    run = 122,
+}
+
+--<<< UNITS
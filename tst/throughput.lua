@@ -0,0 +1,120 @@
+#!/usr/bin/env lua5.3
+
+-- Compiler throughput benchmark.
+--
+-- Generates large synthetic programs and measures the time of the compiler
+-- passes (`--ceu` only, no C compilation):
+--      - "pars":  one `par/and` with N trails
+--      - "codes": N code abstractions, each invoked once
+--
+-- Usage:
+--      $ cd tst/
+--      $ lua5.3 throughput.lua [N1 N2 ...]     (default: 250 500 1000)
+
+TESTS = {}  -- options are set below (see `cmd.lua`)
+
+local GEN = {
+    pars = function (n)
+        local t = { 'input none A;\nvar int ret = 0;\npar/and do\n' }
+        for i=1, n do
+            if i > 1 then
+                t[#t+1] = 'with\n'
+            end
+            t[#t+1] = '    await A;\n    ret = ret + '..i..';\n'
+        end
+        t[#t+1] = 'end\nescape ret;\n'
+        return table.concat(t)
+    end,
+
+    codes = function (n)
+        local t = { 'input none A;\n' }
+        for i=1, n do
+            t[#t+1] = 'code/await Ff_'..i..' (var int x) -> int do\n'..
+                      '    await A;\n'..
+                      '    escape x + '..i..';\n'..
+                      'end\n'
+        end
+        t[#t+1] = 'var int ret = 0;\n'
+        for i=1, n do
+            t[#t+1] = 'spawn Ff_'..i..'('..i..');\n'
+        end
+        t[#t+1] = 'escape ret;\n'
+        return table.concat(t)
+    end,
+}
+
+local PASSES = {
+    'lines', 'parser', 'ast', 'adjs', 'types', 'exps', 'dcls', 'inlines',
+    'consts', 'fins', 'spawns', 'stmts', 'inits', 'ptrs', 'scopes',
+    'tight_', 'props_', 'trails', 'labels', 'vals', 'multis', 'mems', 'codes',
+}
+
+local DIR = '../src/lua/'
+
+local function compile (src)
+    local f = assert(io.open('/tmp/throughput.ceu', 'w'))
+    f:write(src)
+    f:close()
+
+    PAK = {
+        lua_exe = '?',
+        ceu_ver = '?',
+        ceu_git = '?',
+        files = {
+            ceu_c = assert(io.open'../src/c/ceu_callback.c'):read'*a'..
+                    assert(io.open'../src/c/ceu_vector.c'):read'*a'..
+                    assert(io.open'../src/c/ceu_pool.c'):read'*a'..
+                    assert(io.open'../src/c/ceu.c'):read'*a',
+        }
+    }
+    CEU = {
+        arg  = {},
+        opts = {
+            ceu        = true,
+            ceu_input  = '/tmp/throughput.ceu',
+            ceu_output = '/tmp/throughput.ceu.c',
+        }
+    }
+
+    dofile(DIR..'dbg.lua')
+    DBG,ASR = DBG1,ASR1
+    dofile(DIR..'cmd.lua')
+
+    collectgarbage()
+    local t0 = os.clock()
+    for _, pass in ipairs(PASSES) do
+        if pass == 'adjs' then
+            DBG,ASR = DBG2,ASR2
+        end
+        dofile(DIR..pass..'.lua')
+    end
+    local t1 = os.clock()
+    DBG,ASR = DBG1,ASR1
+
+    local f = assert(io.open(CEU.opts.ceu_output))
+    local bytes = #f:read'*a'
+    f:close()
+
+    return t1-t0, bytes
+end
+
+local NS = {}
+for i, v in ipairs(arg) do
+    NS[i] = assert(tonumber(v), 'invalid N: '..v)
+end
+if #NS == 0 then
+    NS = { 250, 500, 1000 }
+end
+
+print('THROUGHPUT = {')
+for _, kind in ipairs{'pars','codes'} do
+    for _, n in ipairs(NS) do
+        local src = GEN[kind](n)
+        local secs, bytes = compile(src)
+        print(string.format(
+            '    { kind=%q, n=%d, lines=%d, secs=%.3f, c_bytes=%d, c_bytes_per_sec=%d },',
+            kind, n, select(2,string.gsub(src,'\n','')), secs, bytes,
+            math.floor(bytes/secs)))
+    end
+end
+print('}')